@@ -36,9 +36,11 @@
 */
 
 #include <cmath>
+#include <memory>
 #include <vector>
 #include <utility>
 #include "mayandef.hpp"
+#include "mayanmem.hpp"
 
 
 namespace MayanSort {
@@ -56,15 +58,17 @@ namespace MayanSort {
         }
 
         //To merger array[start to middle] and array[middle to end] in ascending order
-        template<typename T, typename RandomAccessIterator, typename Size, typename Comp>
-        void _merge(RandomAccessIterator array, Size start, Size middle, Size end, Comp comp)
+        //The first part is copied to temp, which is shared by all the merges of a sort
+        template<typename T, typename RandomAccessIterator, typename Size, typename Comp, typename Alloc>
+        void _merge(RandomAccessIterator array, Size start, Size middle, Size end, Comp comp,
+            _mem::buffer<T, Alloc>& temp)
         {
             Size first_array_size = middle - start;
 
-            T* temp_array = new T[first_array_size];
+            T* temp_array = temp.prime(array + start, first_array_size);
 
             for (Size iterator = 0; iterator < first_array_size; ++iterator)
-                temp_array[iterator] = array[start + iterator];
+                temp_array[iterator] = std::move(array[start + iterator]);
 
             Size temp_array_iterator = 0;
             Size second_array_iterator = middle;
@@ -76,7 +80,7 @@ namespace MayanSort {
 
                 if (comp(temp_array[temp_array_iterator], array[second_array_iterator]))
                 {
-                    array[array_iterator] = temp_array[temp_array_iterator];
+                    array[array_iterator] = std::move(temp_array[temp_array_iterator]);
 
                     array_iterator++;
                     temp_array_iterator++;
@@ -85,7 +89,7 @@ namespace MayanSort {
 
                 else
                 {
-                    array[array_iterator] = array[second_array_iterator];
+                    array[array_iterator] = std::move(array[second_array_iterator]);
 
                     array_iterator++;
                     second_array_iterator++;
@@ -94,17 +98,17 @@ namespace MayanSort {
             }
             while (temp_array_iterator < first_array_size)
             {
-                array[array_iterator] = temp_array[temp_array_iterator];
+                array[array_iterator] = std::move(temp_array[temp_array_iterator]);
 
                 array_iterator++;
                 temp_array_iterator++;
             }
-            delete[] temp_array;
         }
 
         //Merger version 1 is used to sort array which are mostly sorted
-        template<typename T, typename RandomAccessIterator, typename Size, typename Comp>
-        void _merge_mostly_sorted(RandomAccessIterator array, Size start, Size end, Comp comp)
+        template<typename T, typename RandomAccessIterator, typename Size, typename Comp, typename Alloc>
+        void _merge_mostly_sorted(RandomAccessIterator array, Size start, Size end, Comp comp,
+            _mem::buffer<T, Alloc>& temp)
         {
             Size merge_iterator_start = start;
             Size merge_iterator_middle = start;
@@ -126,7 +130,7 @@ namespace MayanSort {
 
                     _merge<T>(array, merge_iterator_start,
                         merge_iterator_middle,
-                        merge_iterator_end, comp);
+                        merge_iterator_end, comp, temp);
 
                     merge_iterator_start = merge_iterator_end;
                     merge_iterator_end++;
@@ -165,8 +169,9 @@ namespace MayanSort {
         }
 
         //Merger version 2 is used to sort array which are less started
-        template<typename T, typename RandomAccessIterator, typename Size, typename Comp>
-        void _merge_less_started(RandomAccessIterator array, Size start, Size end, Comp comp)
+        template<typename T, typename RandomAccessIterator, typename Size, typename Comp, typename Alloc>
+        void _merge_less_started(RandomAccessIterator array, Size start, Size end, Comp comp,
+            _mem::buffer<T, Alloc>& temp)
         {
 
             Size merge_iterator_start = 0;
@@ -175,7 +180,7 @@ namespace MayanSort {
 
             Size step_counter = 1;
 
-            std::vector<Size> sorted_subarray_end_points;
+            std::vector<Size, _mem::rebind_t<Alloc, Size> > sorted_subarray_end_points(temp.get_allocator());
 
             sorted_subarray_end_points.push_back((Size)0);
 
@@ -207,7 +212,7 @@ namespace MayanSort {
 
                     _merge<T>(array, sorted_subarray_end_points[merge_iterator_start],
                         sorted_subarray_end_points[merge_iterator_middle],
-                        sorted_subarray_end_points[merge_iterator_end], comp);
+                        sorted_subarray_end_points[merge_iterator_end], comp, temp);
 
                     merge_iterator_start = merge_iterator_end;
                     merge_iterator_middle = merge_iterator_start + step_counter;
@@ -224,8 +229,9 @@ namespace MayanSort {
 
         //Function that reverses large enough decreasingly sorted subarray and
         //decides if array has to go through version 1 or 2 of merger
-        template<typename T, typename RandomAccessIterator, typename Size, typename Comp>
-        void _aroot_sort_loop(RandomAccessIterator array, Size start, Size end, Comp comp)
+        template<typename T, typename RandomAccessIterator, typename Size, typename Comp, typename Alloc>
+        void _aroot_sort_loop(RandomAccessIterator array, Size start, Size end, Comp comp,
+            _mem::buffer<T, Alloc>& temp)
         {
 
             Size array_iterator_1 = 0;
@@ -259,16 +265,20 @@ namespace MayanSort {
             }
 
             if (number_of_decreasing_subarray <= optimal_near_sorted_parameter)
-                _merge_mostly_sorted<T>(array, start, end, comp);
+                _merge_mostly_sorted<T>(array, start, end, comp, temp);
             else
-                _merge_less_started<T>(array, start, end, comp);
+                _merge_less_started<T>(array, start, end, comp, temp);
         }
 
-        template<typename RandomAccessIterator, typename Comp>
-        void aroot_sort(RandomAccessIterator first, RandomAccessIterator last, Comp comp) {
+        //The merge buffer is taken from alloc, rebound to the element type (see mayanmem.hpp)
+        template<typename RandomAccessIterator, typename Comp,
+            typename Alloc = std::allocator<MayanSort::ItValue<RandomAccessIterator> > >
+        void aroot_sort(RandomAccessIterator first, RandomAccessIterator last, Comp comp,
+            const Alloc& alloc = Alloc()) {
             typedef typename MayanSort::ItValue<RandomAccessIterator> T;
             typedef typename MayanSort::ItSize<RandomAccessIterator> Size;
-            _aroot_sort_loop<T>(first, (Size)0, std::distance(first, last), comp);
+            _mem::buffer<T, Alloc> temp(alloc);
+            _aroot_sort_loop<T>(first, (Size)0, std::distance(first, last), comp, temp);
         }
 
 
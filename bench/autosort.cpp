@@ -0,0 +1,96 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// bench/autosort.cpp: Cost of the probe of AutoSort and AutoStableSort on random data.
+// For every type and size, times ProbeInput() alone and the engine it picks, and prints the
+// probe time as a share of the sort. Build from the repository root with
+//     g++ -std=c++20 -O2 -I. bench/autosort.cpp -o autosort_bench
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mayansort.hpp"
+
+namespace {
+    const char* engine_name(MayanSort::AutoEngine engine) {
+        static const char* const names[] = { "PDQSort", "VergeSort", "TimSort", "DropMergeSort", "RadixSort", "IndieSort" };
+        return names[int(engine)];
+    }
+
+    // Best time of f() over enough runs to take about 0.2 s, in nanoseconds.
+    template<typename F>
+    double best_ns(F f) {
+        typedef std::chrono::steady_clock clock;
+        double best = 1e300, total = 0;
+        for (int run = 0; run < 3 || (total < 2e8 && run < 10000); ++run) {
+            clock::time_point start = clock::now();
+            f();
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            best = std::min(best, ns);
+            total += ns;
+        }
+        return best;
+    }
+
+    template<typename T>
+    T make(std::mt19937_64& rng) {
+        if constexpr (std::is_same_v<T, std::string>) return "key" + std::to_string(rng() % 100000000);
+        else return T(rng());
+    }
+
+    template<typename T>
+    void bench(const char* type, std::size_t n, bool stable) {
+        std::mt19937_64 rng(n);
+        std::vector<T> input(n), v;
+        for (T& x : input) x = make<T>(rng);
+
+        MayanSort::SortProbe probe{};
+        double probe_ns = best_ns([&] {
+            probe = MayanSort::ProbeInput(input.begin(), input.end(), std::less<T>());
+        });
+        MayanSort::AutoEngine engine = MayanSort::AutoSortChoose(probe, stable);
+
+        // The copy of the input is timed too, and taken off with the time of a copy alone.
+        double copy_ns = best_ns([&] { v = input; });
+        double sort_ns = best_ns([&] {
+            v = input;
+            MayanSort::_auto::dispatch(v.begin(), v.end(), std::less<T>(), engine);
+        }) - copy_ns;
+        std::printf("%-7s %-10zu %-6s %-13s probe %10.0f ns  sort %12.0f ns  probe/sort %6.3f%%\n",
+            type, n, stable ? "stable" : "", engine_name(engine), probe_ns, sort_ns, 100 * probe_ns / sort_ns);
+    }
+}
+
+int main() {
+    for (bool stable : { false, true }) {
+        for (std::size_t n : { 1000, 2048, 10000, 100000, 1000000, 10000000 }) {
+            bench<int>("int32", n, stable);
+            bench<double>("double", n, stable);
+            if (n <= 1000000) bench<std::string>("string", n, stable);
+        }
+    }
+}
@@ -0,0 +1,440 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// bench/bench.cpp: Benchmark of every sort wrapper of mayansort.hpp over input distributions,
+// element types and sizes.
+// Every (algorithm, type, distribution, size) cell is sorted repeatedly for --min-time seconds,
+// in batches of copies of the input for small sizes, and reports the median time per element.
+// The timed runs compare with std::less, so the vector kernels are in use. A separate run counts
+// the comparisons, moves and swaps of one sort of the same input with CountSort() (see
+// mayancount.hpp). Sorts that do not take a comparison, the radix ones, have no counts.
+// With --perf, one more sort of the input is run under hardware counters (see mayanperf.hpp),
+// whose totals are added as columns, empty where the system does not offer them.
+// Quadratic and slower algorithms are only run up to a size that finishes in seconds, unless
+// --all-sizes is given, and cells whose input and scratch would not fit in --max-bytes are
+// skipped.
+//
+// Build from the repository root:
+//     g++ -std=c++20 -O2 -pthread -I. bench/bench.cpp -o mayansort_bench
+// Usage:
+//     mayansort_bench [--format csv|json] [--algos A,B,...] [--types T,...] [--dists D,...]
+//                     [--sizes N,...] [--min-time SECONDS] [--count-max N] [--max-bytes N]
+//                     [--all-sizes] [--perf] [--list]
+// Types: int32 int64 double string rec16 rec64 rec256.
+// Distributions: random sorted reversed organ_pipe sawtooth few_unique random_runs sorted_noise.
+// Sizes default to 10, 100, ... 1e8, counts to sizes up to 1e6.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mayansort.hpp"
+
+namespace {
+    // Record of N bytes ordered by its first 8.
+    template<std::size_t N>
+    struct Record {
+        std::uint64_t key;
+        unsigned char payload[N - sizeof(std::uint64_t)];
+
+        friend bool operator<(const Record& a, const Record& b) { return a.key < b.key; }
+        friend bool operator>(const Record& a, const Record& b) { return b.key < a.key; }
+        friend bool operator<=(const Record& a, const Record& b) { return a.key <= b.key; }
+        friend bool operator>=(const Record& a, const Record& b) { return a.key >= b.key; }
+        friend bool operator==(const Record& a, const Record& b) { return a.key == b.key; }
+    };
+
+    // Element of each type for a 64-bit key, in the same order as the keys.
+    template<typename T>
+    T make(std::uint64_t key) {
+        if constexpr (std::is_same_v<T, std::int32_t>) return std::int32_t(key >> 33);
+        else if constexpr (std::is_same_v<T, std::int64_t>) return std::int64_t(key >> 1);
+        else if constexpr (std::is_same_v<T, double>) return double(key >> 11) * 0x1p-53;
+        else if constexpr (std::is_same_v<T, std::string>) {
+            char text[17];
+            std::snprintf(text, sizeof text, "%016llx", (unsigned long long)key);
+            return text;
+        }
+        else {
+            T record;
+            record.key = key;
+            std::memset(record.payload, int(key & 0xff), sizeof record.payload);
+            return record;
+        }
+    }
+
+    // Bytes an element takes, its heap part included.
+    template<typename T>
+    std::size_t footprint() {
+        return sizeof(T) + (std::is_same_v<T, std::string> ? 32 : 0);
+    }
+
+    const char* const distributions[] = {
+        "random", "sorted", "reversed", "organ_pipe", "sawtooth", "few_unique", "random_runs", "sorted_noise"
+    };
+
+    // Keys of n elements in a distribution, the same for every type and algorithm.
+    std::vector<std::uint64_t> make_keys(const std::string& dist, std::size_t n) {
+        std::mt19937_64 rng(n * 31 + dist.size());
+        std::vector<std::uint64_t> keys(n);
+        for (std::uint64_t& k : keys) k = rng();
+
+        if (dist == "sorted") std::sort(keys.begin(), keys.end());
+        else if (dist == "reversed") std::sort(keys.begin(), keys.end(), std::greater<>());
+        else if (dist == "organ_pipe") {
+            // Up through the even ranks, down through the odd ones.
+            std::vector<std::uint64_t> sorted = keys;
+            std::sort(sorted.begin(), sorted.end());
+            for (std::size_t i = 0; i < n; ++i)
+                keys[i] = i < (n + 1) / 2 ? sorted[2 * i] : sorted[2 * (n - 1 - i) + 1];
+        }
+        else if (dist == "sawtooth") {
+            // 16 ascending teeth.
+            std::size_t teeth = std::min<std::size_t>(16, std::max<std::size_t>(n, 1));
+            for (std::size_t t = 0; t < teeth; ++t)
+                std::sort(keys.begin() + t * n / teeth, keys.begin() + (t + 1) * n / teeth);
+        }
+        else if (dist == "few_unique") {
+            std::uint64_t values[16];
+            for (std::uint64_t& v : values) v = rng();
+            for (std::uint64_t& k : keys) k = values[k % 16];
+        }
+        else if (dist == "random_runs") {
+            // Runs of up to 2 sqrt(n) elements, ascending or descending.
+            std::size_t max_run = std::max<std::size_t>(1, std::size_t(2 * std::sqrt(double(n))));
+            for (std::size_t i = 0; i < n;) {
+                std::size_t len = std::min(n - i, 1 + std::size_t(rng() % max_run));
+                if (rng() & 1) std::sort(keys.begin() + i, keys.begin() + (i + len));
+                else std::sort(keys.begin() + i, keys.begin() + (i + len), std::greater<>());
+                i += len;
+            }
+        }
+        else if (dist == "sorted_noise") {
+            // Sorted, with 1% of the elements replaced by random ones.
+            std::sort(keys.begin(), keys.end());
+            for (std::size_t i = 0, noise = std::max<std::size_t>(1, n / 100); i < noise && n > 0; ++i)
+                keys[rng() % n] = rng();
+        }
+        return keys;
+    }
+
+    // How an algorithm scales, for its default size limit.
+    enum class Cost { n_log_n, quadratic, cubic, superpolynomial, factorial, factorial_squared };
+
+    std::size_t size_limit(Cost cost) {
+        switch (cost) {
+        case Cost::quadratic: return 10000;
+        case Cost::cubic: return 1000;
+        case Cost::superpolynomial: return 100;
+        case Cost::factorial: return 8;
+        case Cost::factorial_squared: return 6;
+        default: return std::size_t(-1);
+        }
+    }
+
+    template<typename T>
+    struct Algorithm {
+        const char* name;
+        Cost cost;
+        void (*sort)(T*, T*);
+        MayanSort::SortCounts (*count)(T*, T*); // Null if the sort takes no comparison.
+    };
+
+#define BENCH_SORT(name, cost) \
+    Algorithm<T>{ #name, Cost::cost, [](T* f, T* l) { MayanSort::name(f, l); }, \
+        [](T* f, T* l) { return MayanSort::CountSort(f, l, [](auto cf, auto cl, auto cc) { MayanSort::name(cf, cl, cc); }); } }
+
+#define BENCH_KEY_SORT(name) \
+    Algorithm<T>{ #name, Cost::n_log_n, [](T* f, T* l) { MayanSort::name(f, l); }, nullptr }
+
+    template<typename T>
+    std::vector<Algorithm<T>> algorithms() {
+        std::vector<Algorithm<T>> list = {
+            BENCH_SORT(IntroSort, n_log_n),
+            BENCH_SORT(MergeSortBottomUp, n_log_n),
+            BENCH_SORT(WikiSort, n_log_n),
+            BENCH_SORT(PDQSort, n_log_n),
+            BENCH_SORT(PDQSortBranchless, n_log_n),
+            BENCH_SORT(ParallelPDQSort, n_log_n),
+            BENCH_SORT(GrailSort, n_log_n),
+            BENCH_SORT(QuickMergeSort, n_log_n),
+            BENCH_SORT(MergeSort, n_log_n),
+            BENCH_SORT(DropMergeSort, n_log_n),
+            BENCH_SORT(QuickSort, n_log_n),
+            BENCH_SORT(LazyStableSort, quadratic),
+            BENCH_SORT(TimSort, n_log_n),
+            BENCH_SORT(ParallelTimSort, n_log_n),
+            BENCH_SORT(GoSort, n_log_n),
+            BENCH_SORT(GoStableSort, n_log_n),
+            BENCH_SORT(QuickSortDualPivot, n_log_n),
+            BENCH_SORT(BubbleSort, quadratic),
+            BENCH_SORT(SelectionSort, quadratic),
+            BENCH_SORT(InsertSort, quadratic),
+            BENCH_SORT(InsertSortBinary, quadratic),
+            BENCH_SORT(VergeSort, n_log_n),
+            BENCH_SORT(QuickSortDualPivotFast, n_log_n),
+            BENCH_SORT(PoplarHeapSort, n_log_n),
+            BENCH_SORT(CircleSort, quadratic),
+            BENCH_SORT(GnomeSort, quadratic),
+            BENCH_SORT(CombSort, n_log_n),
+            BENCH_SORT(ShellSort, n_log_n),
+            BENCH_SORT(TernaryHeapSort, n_log_n),
+            BENCH_SORT(PatienceSort, quadratic),
+            BENCH_SORT(OddEvenSort, quadratic),
+            BENCH_SORT(SillySort, cubic),
+            BENCH_SORT(BitonicSort, n_log_n),
+            BENCH_SORT(SmoothSort, n_log_n),
+            BENCH_SORT(WeakHeapSort, n_log_n),
+            BENCH_SORT(CombSort11, n_log_n),
+            BENCH_SORT(DoubleSelectionSort, quadratic),
+            BENCH_SORT(ShiftSort, n_log_n),
+            BENCH_SORT(BogoSort, factorial),
+            BENCH_SORT(BogoBogoSort, factorial_squared),
+            BENCH_SORT(StoogeSort, cubic),
+            BENCH_SORT(SlowSort, superpolynomial),
+            BENCH_SORT(RotateMergeSort, n_log_n),
+            BENCH_SORT(StableQuickSort, n_log_n),
+            BENCH_SORT(DoubleInsertSort, quadratic),
+            BENCH_SORT(IndieSort, n_log_n),
+            BENCH_SORT(NanoSort, n_log_n),
+            BENCH_SORT(ARootSort, n_log_n),
+            BENCH_SORT(HeapSort, n_log_n),
+            BENCH_SORT(HayateSort, n_log_n),
+            BENCH_SORT(WeaveMergeSort, quadratic),
+            BENCH_SORT(SqrtSort, n_log_n),
+            BENCH_SORT(SampleSort, n_log_n),
+            BENCH_SORT(ParallelSampleSort, n_log_n),
+            BENCH_SORT(AutoSort, n_log_n),
+            BENCH_SORT(AutoStableSort, n_log_n),
+        };
+        if constexpr (MayanSort::radix_detail::radix_key<T>) list.push_back(BENCH_KEY_SORT(RadixSort));
+        if constexpr (MayanSort::msd_radix_detail::msd_key<T>) list.push_back(BENCH_KEY_SORT(InPlaceRadixSort));
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) list.push_back(BENCH_KEY_SORT(StringSort));
+        return list;
+    }
+
+    struct Options {
+        std::string format = "csv";
+        std::vector<std::string> algos, types, dists;
+        std::vector<std::size_t> sizes = { 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+        double min_time = 0.05;
+        std::size_t count_max = 1000000;
+        std::size_t max_bytes = std::size_t(2) << 30;
+        bool all_sizes = false;
+        bool perf = false;
+        bool list = false;
+    };
+
+    std::vector<std::string> split(const char* text) {
+        std::vector<std::string> parts;
+        std::string part;
+        for (const char* c = text;; ++c) {
+            if (*c == ',' || *c == 0) {
+                if (!part.empty()) parts.push_back(part);
+                part.clear();
+                if (*c == 0) return parts;
+            }
+            else part += *c;
+        }
+    }
+
+    bool selected(const std::vector<std::string>& filter, const std::string& name) {
+        return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+    }
+
+    struct Result {
+        const char* algorithm;
+        const char* type;
+        const char* distribution;
+        std::size_t n;
+        double ns_per_element;
+        long long comparisons; // -1 if not counted.
+        long long moves;
+        long long swaps;
+        bool sorted;
+        MayanSort::PerfCounts perf;
+    };
+
+    // Open when --perf is given.
+    MayanSort::PerfSession* perf_session = nullptr;
+
+    void print(const Options& options, const Result& r, bool first) {
+        if (options.format == "json") {
+            std::printf("%s\n  {\"algorithm\": \"%s\", \"type\": \"%s\", \"distribution\": \"%s\", \"n\": %zu, "
+                "\"ns_per_element\": %.4f, ", first ? "" : ",", r.algorithm, r.type, r.distribution, r.n, r.ns_per_element);
+            if (r.comparisons < 0) std::printf("\"comparisons\": null, \"moves\": null, \"swaps\": null, ");
+            else std::printf("\"comparisons\": %lld, \"moves\": %lld, \"swaps\": %lld, ", r.comparisons, r.moves, r.swaps);
+            std::printf("\"sorted\": %s", r.sorted ? "true" : "false");
+            if (options.perf) {
+                for (int e = 0; e < MayanSort::_perf::events; ++e) {
+                    long long value = r.perf.*MayanSort::_perf::fields[e];
+                    if (value < 0) std::printf(", \"%s\": null", MayanSort::_perf::names[e]);
+                    else std::printf(", \"%s\": %lld", MayanSort::_perf::names[e], value);
+                }
+            }
+            std::printf("}");
+        }
+        else {
+            std::printf("%s,%s,%s,%zu,%.4f,", r.algorithm, r.type, r.distribution, r.n, r.ns_per_element);
+            if (r.comparisons < 0) std::printf(",,,");
+            else std::printf("%lld,%lld,%lld,", r.comparisons, r.moves, r.swaps);
+            std::printf("%d", int(r.sorted));
+            if (options.perf) {
+                for (std::int64_t MayanSort::PerfCounts::* field : MayanSort::_perf::fields) {
+                    if (r.perf.*field < 0) std::printf(",");
+                    else std::printf(",%lld", (long long)(r.perf.*field));
+                }
+            }
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+    }
+
+    bool first_result = true;
+
+    template<typename T>
+    void run_type(const Options& options, const char* type) {
+        if (!selected(options.types, type)) return;
+        std::vector<Algorithm<T>> list = algorithms<T>();
+
+        for (const char* dist : distributions) {
+            if (!selected(options.dists, dist)) continue;
+            for (std::size_t n : options.sizes) {
+                // The input, a batch of copies and the scratch memory of the sorts.
+                if (3 * n * footprint<T>() > options.max_bytes) continue;
+
+                std::vector<std::uint64_t> keys = make_keys(dist, n);
+                std::vector<T> input(n);
+                for (std::size_t i = 0; i < n; ++i) input[i] = make<T>(keys[i]);
+
+                // Sort batches of at least 4096 elements, so that the clock is read rarely enough.
+                std::size_t copies = std::max<std::size_t>(1, 4096 / std::max<std::size_t>(n, 1));
+                std::vector<T> batch;
+
+                for (const Algorithm<T>& algo : list) {
+                    if (!selected(options.algos, algo.name)) continue;
+                    if (!options.all_sizes && n > size_limit(algo.cost)) continue;
+                    std::size_t algo_copies = algo.cost == Cost::n_log_n || algo.cost == Cost::quadratic ? copies : 1;
+
+                    typedef std::chrono::steady_clock clock;
+                    std::vector<double> times;
+                    double total = 0;
+                    bool sorted = true;
+                    do {
+                        batch.clear();
+                        for (std::size_t c = 0; c < algo_copies; ++c) batch.insert(batch.end(), input.begin(), input.end());
+                        clock::time_point start = clock::now();
+                        for (std::size_t c = 0; c < algo_copies; ++c) algo.sort(batch.data() + c * n, batch.data() + (c + 1) * n);
+                        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+                        total += seconds;
+                        times.push_back(seconds * 1e9 / double(std::max<std::size_t>(n, 1) * algo_copies));
+                        if (times.size() == 1) {
+                            for (std::size_t c = 0; c < algo_copies; ++c)
+                                sorted = sorted && std::is_sorted(batch.begin() + c * n, batch.begin() + (c + 1) * n);
+                        }
+                    } while (total < options.min_time);
+                    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+
+                    Result result = { algo.name, type, dist, n, times[times.size() / 2], -1, -1, -1, sorted, {} };
+                    if (algo.count && n <= options.count_max) {
+                        batch.assign(input.begin(), input.end());
+                        MayanSort::SortCounts counts = algo.count(batch.data(), batch.data() + n);
+                        result.comparisons = (long long)counts.comparisons;
+                        result.moves = (long long)counts.moves;
+                        result.swaps = (long long)counts.swaps;
+                    }
+                    if (perf_session) {
+                        batch.assign(input.begin(), input.end());
+                        result.perf = perf_session->Measure(algo.name, n, [&] { algo.sort(batch.data(), batch.data() + n); });
+                        perf_session->Clear();
+                    }
+                    print(options, result, first_result);
+                    first_result = false;
+                }
+            }
+        }
+    }
+
+    int usage(const char* program) {
+        std::fprintf(stderr, "usage: %s [--format csv|json] [--algos A,B,...] [--types T,...] [--dists D,...]\n"
+            "    [--sizes N,...] [--min-time SECONDS] [--count-max N] [--max-bytes N] [--all-sizes] [--perf] [--list]\n", program);
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--all-sizes") options.all_sizes = true;
+        else if (arg == "--perf") options.perf = true;
+        else if (arg == "--list") options.list = true;
+        else if (!has_value) return usage(argv[0]);
+        else if (arg == "--format") options.format = argv[++i];
+        else if (arg == "--algos") options.algos = split(argv[++i]);
+        else if (arg == "--types") options.types = split(argv[++i]);
+        else if (arg == "--dists") options.dists = split(argv[++i]);
+        else if (arg == "--min-time") options.min_time = std::atof(argv[++i]);
+        else if (arg == "--count-max") options.count_max = std::size_t(std::atof(argv[++i]));
+        else if (arg == "--max-bytes") options.max_bytes = std::size_t(std::atof(argv[++i]));
+        else if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const std::string& s : split(argv[++i])) options.sizes.push_back(std::size_t(std::atof(s.c_str())));
+        }
+        else return usage(argv[0]);
+    }
+    if (options.format != "csv" && options.format != "json") return usage(argv[0]);
+
+    if (options.list) {
+        for (const Algorithm<std::int32_t>& algo : algorithms<std::int32_t>()) std::printf("%s\n", algo.name);
+        std::printf("StringSort\n");
+        return 0;
+    }
+
+    MayanSort::PerfSession session;
+    if (options.perf) perf_session = &session;
+
+    if (options.format == "json") std::printf("[");
+    else {
+        std::printf("algorithm,type,distribution,n,ns_per_element,comparisons,moves,swaps,sorted");
+        if (options.perf) for (const char* name : MayanSort::_perf::names) std::printf(",%s", name);
+        std::printf("\n");
+    }
+    run_type<std::int32_t>(options, "int32");
+    run_type<std::int64_t>(options, "int64");
+    run_type<double>(options, "double");
+    run_type<std::string>(options, "string");
+    run_type<Record<16>>(options, "rec16");
+    run_type<Record<64>>(options, "rec64");
+    run_type<Record<256>>(options, "rec256");
+    if (options.format == "json") std::printf("\n]\n");
+    return 0;
+}
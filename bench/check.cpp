@@ -0,0 +1,85 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// bench/check.cpp: Inputs that made sorts lose elements or crash. Every case is sorted by the
+// wrapper under test and compared with std::sort; the program prints the failing cases and
+// exits with 1 if there are any. Build from the repository root with
+//     g++ -std=c++20 -O2 -I. bench/check.cpp -o check
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mayansort.hpp"
+
+namespace {
+    int failures = 0;
+
+    template<typename T, typename Sort>
+    void check(const char* name, const char* input, std::vector<T> v, Sort sort) {
+        std::vector<T> expected = v;
+        std::sort(expected.begin(), expected.end());
+        sort(v.begin(), v.end());
+        if (v != expected) {
+            std::printf("FAIL %s %s n=%zu\n", name, input, v.size());
+            ++failures;
+        }
+    }
+
+    // n strings drawn from `distinct` values, each long enough to live on the heap.
+    std::vector<std::string> few_unique_strings(std::size_t n, unsigned distinct) {
+        std::mt19937_64 rng(n);
+        std::vector<std::string> v(n);
+        for (std::string& s : v) s = "a long enough key number " + std::to_string(rng() % distinct);
+        return v;
+    }
+
+    std::vector<int> reversed_ints(std::size_t n) {
+        std::vector<int> v(n);
+        for (std::size_t i = 0; i < n; ++i) v[i] = int(n - i);
+        return v;
+    }
+}
+
+int main() {
+    // HayateSort moved elements onto themselves when joining runs, which empties std::string.
+    for (std::size_t n : { 1000, 10000 }) {
+        for (unsigned distinct : { 3, 97 }) {
+            check("HayateSort", "string few_unique", few_unique_strings(n, distinct),
+                [](auto first, auto last) { MayanSort::HayateSort(first, last); });
+        }
+    }
+
+    // QuickSortDualPivot took the ends as pivots and recursed on every part: quadratic on
+    // reversed input and out of stack at a million elements.
+    check("QuickSortDualPivot", "int reversed", reversed_ints(1000000),
+        [](auto first, auto last) { MayanSort::QuickSortDualPivot(first, last); });
+    check("QuickSortDualPivot", "string few_unique", few_unique_strings(100000, 3),
+        [](auto first, auto last) { MayanSort::QuickSortDualPivot(first, last); });
+
+    if (failures == 0) std::puts("all passed");
+    return failures ? 1 : 0;
+}
@@ -27,6 +27,10 @@
 #include <algorithm>
 #include <type_traits>
 #include <iterator>
+#include <memory>
+
+#include "mayanmem.hpp"
+#include "mayansimd.hpp"
 
 /*
     A C++ reimplementation of a drop-merge sort, originally made by Emil Ernerfeldt:
@@ -49,15 +53,15 @@ namespace MayanSort {
         constexpr static bool double_comparison = true;
 
         // with-trivial-copies version
-        template<typename Iter, typename Comp>
-        void dmsort(Iter begin, Iter end, Comp comp, std::true_type) {
+        template<typename Iter, typename Comp, typename Alloc>
+        void dmsort(Iter begin, Iter end, Comp comp, const Alloc& alloc, std::true_type) {
             size_t size = end - begin;
 
             if (size < 2)
                 return;
 
             using Value = typename std::iterator_traits<Iter>::value_type;
-            std::vector<Value> dropped;
+            std::vector<Value, _mem::rebind_t<Alloc, Value> > dropped(alloc);
 
             size_t num_dropped_in_row = 0;
             auto write = begin;
@@ -93,11 +97,12 @@ namespace MayanSort {
                     }
                 }
                 else {
-                    // Here we don't need to guard against self-move because such an
-                    // operation can't destroy the value for trivially copyable types
-                    *write = std::move(*read);
-                    ++read;
-                    ++write;
+                    // The elements kept from here on are those of the run that starts at read,
+                    // scanned with vectors for arithmetic keys (see mayansimd.hpp). They only
+                    // need to move once something was dropped
+                    Iter run_end = _simd::run_end<false, false>(read, end, comp);
+                    write = write == read ? run_end : std::move(read, run_end, write);
+                    read = run_end;
                     num_dropped_in_row = 0;
                 }
             }
@@ -121,15 +126,15 @@ namespace MayanSort {
         }
 
         // move-only version
-        template<typename Iter, typename Comp>
-        void dmsort(Iter begin, Iter end, Comp comp, std::false_type) {
+        template<typename Iter, typename Comp, typename Alloc>
+        void dmsort(Iter begin, Iter end, Comp comp, const Alloc& alloc, std::false_type) {
             size_t size = end - begin;
 
             if (size < 2)
                 return;
 
             using Value = typename std::iterator_traits<Iter>::value_type;
-            std::vector<Value> dropped;
+            std::vector<Value, _mem::rebind_t<Alloc, Value> > dropped(alloc);
 
             size_t num_dropped_in_row = 0;
             auto write = begin;
@@ -193,10 +198,13 @@ namespace MayanSort {
             }
         }
     }
-    template<typename Iter, typename Comp>
-    void dmsort(Iter begin, Iter end, Comp comp) {
+    // The dropped elements are kept in a vector that takes its memory from alloc, rebound to the
+    // element type (see mayanmem.hpp).
+    template<typename Iter, typename Comp,
+        typename Alloc = std::allocator<typename std::iterator_traits<Iter>::value_type> >
+    void dmsort(Iter begin, Iter end, Comp comp, const Alloc& alloc = Alloc()) {
         using Value = typename std::iterator_traits<Iter>::value_type;
-        detail::dmsort(begin, end, comp, std::is_trivially_copyable<Value>());
+        detail::dmsort(begin, end, comp, alloc, std::is_trivially_copyable<Value>());
     }
     template<typename Iter>
     void dmsort(Iter begin, Iter end) {
@@ -83,6 +83,9 @@
 #include <type_traits>
 #include <utility>
 
+#include "mayansimd.hpp"
+#include "mayantrace.hpp"
+
 
 namespace MayanSort {
 	namespace grailsort_detail
@@ -116,20 +119,22 @@ namespace MayanSort {
 			}
 		};
 
+		// Size is the type of the indices and lengths, the difference_type of the iterators.
+		template<typename Size>
 		struct GrailSort
 		{
-			int currBlockLen;
+			Size currBlockLen;
 			Subarray currBlockOrigin;
 
 			template<typename RandomAccessIterator>
-			static void BlockSwap(RandomAccessIterator array, int a, int b, int blockLen) {
+			static void BlockSwap(RandomAccessIterator array, Size a, Size b, Size blockLen) {
 				std::swap_ranges(array + a, array + (a + blockLen), array + b);
 			}
 
 			// Swaps the order of two adjacent blocks whose lengths may or may not be equal.
 			// Variant of the Gries-Mills algorithm, which is basically recursive block swaps
 			template<typename RandomAccessIterator>
-			static void Rotate(RandomAccessIterator array, int start, int leftLen, int rightLen) {
+			static void Rotate(RandomAccessIterator array, Size start, Size leftLen, Size rightLen) {
 				while (leftLen > 0 && rightLen > 0) {
 					if (leftLen <= rightLen) {
 						BlockSwap(array, start, start + leftLen, leftLen);
@@ -146,10 +151,10 @@ namespace MayanSort {
 			// Variant of Insertion Sort that utilizes swaps instead of overwrites.
 			// Also known as "Optimized Gnomesort".
 			template<typename RandomAccessIterator, typename Compare>
-			static void InsertSort(RandomAccessIterator array, int start, int length, Compare comp) {
-				for (int item = 1; item < length; item++) {
-					int left = start + item - 1;
-					int right = start + item;
+			static void InsertSort(RandomAccessIterator array, Size start, Size length, Compare comp) {
+				for (Size item = 1; item < length; item++) {
+					Size left = start + item - 1;
+					Size right = start + item;
 
 					while (left >= start && comp(array[left], array[right]) > 0) {
 						std::iter_swap(array + left, array + right);
@@ -160,13 +165,13 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare, typename T>
-			static int BinarySearchLeft(RandomAccessIterator array, int start, int length, const T& target, Compare comp) {
-				int left = 0;
-				int right = length;
+			static Size BinarySearchLeft(RandomAccessIterator array, Size start, Size length, const T& target, Compare comp) {
+				Size left = 0;
+				Size right = length;
 
 				while (left < right) {
 					// equivalent to (left + right) / 2 with added overflow protection
-					int middle = left + ((right - left) / 2);
+					Size middle = left + ((right - left) / 2);
 
 					if (comp(array[start + middle], target) < 0) {
 						left = middle + 1;
@@ -180,13 +185,13 @@ namespace MayanSort {
 
 			// Credit to Anonymous0726 for debugging
 			template<typename RandomAccessIterator, typename Compare, typename T>
-			static int BinarySearchRight(RandomAccessIterator array, int start, int length, const T& target, Compare comp) {
-				int left = 0;
-				int right = length;
+			static Size BinarySearchRight(RandomAccessIterator array, Size start, Size length, const T& target, Compare comp) {
+				Size left = 0;
+				Size right = length;
 
 				while (left < right) {
 					// equivalent to (left + right) / 2 with added overflow protection
-					int middle = left + ((right - left) / 2);
+					Size middle = left + ((right - left) / 2);
 					if (comp(array[start + middle], target) > 0) {
 						right = middle;
 					}
@@ -200,16 +205,16 @@ namespace MayanSort {
 
 			// cost: 2 * length + idealKeys^2 / 2
 			template<typename RandomAccessIterator, typename Compare>
-			static int CollectKeys(RandomAccessIterator array, int start, int length, int idealKeys, Compare comp) {
-				int keysFound = 1; // by itself, the first item in the array is our first unique key
-				int firstKey = 0; // the first item in the array is at the first position in the array
-				int currKey = 1; // the index used for finding potentially unique items ("keys") in the array
+			static Size CollectKeys(RandomAccessIterator array, Size start, Size length, Size idealKeys, Compare comp) {
+				Size keysFound = 1; // by itself, the first item in the array is our first unique key
+				Size firstKey = 0; // the first item in the array is at the first position in the array
+				Size currKey = 1; // the index used for finding potentially unique items ("keys") in the array
 
 				while (currKey < length && keysFound < idealKeys) {
 
 					// Find the location in the key-buffer where our current key can be inserted in sorted order.
 					// If the key at insertPos is equal to currKey, then currKey isn't unique and we move on.
-					int insertPos = BinarySearchLeft(array, start + firstKey, keysFound, array[start + currKey], comp);
+					Size insertPos = BinarySearchLeft(array, start + firstKey, keysFound, array[start + currKey], comp);
 
 					// The second part of this conditional does the equal check we were just talking about; however,
 					// if currKey is larger than everything in the key-buffer (meaning insertPos == keysFound),
@@ -240,11 +245,11 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			static void PairwiseSwaps(RandomAccessIterator array, int start, int length, Compare comp) {
-				int index;
+			static void PairwiseSwaps(RandomAccessIterator array, Size start, Size length, Compare comp) {
+				Size index;
 				for (index = 1; index < length; index += 2) {
-					int  left = start + index - 1;
-					int right = start + index;
+					Size  left = start + index - 1;
+					Size right = start + index;
 
 					if (comp(array[left], array[right]) > 0) {
 						std::swap(array[left - 2], array[right]);
@@ -256,18 +261,18 @@ namespace MayanSort {
 					}
 				}
 
-				int left = start + index - 1;
+				Size left = start + index - 1;
 				if (left < start + length) {
 					std::swap(array[left - 2], array[left]);
 				}
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			static void PairwiseWrites(RandomAccessIterator array, int start, int length, Compare comp) {
-				int index;
+			static void PairwiseWrites(RandomAccessIterator array, Size start, Size length, Compare comp) {
+				Size index;
 				for (index = 1; index < length; index += 2) {
-					int  left = start + index - 1;
-					int right = start + index;
+					Size  left = start + index - 1;
+					Size right = start + index;
 
 					if (comp(array[left], array[right]) > 0) {
 						array[left - 2] = std::move(array[right]);
@@ -279,7 +284,7 @@ namespace MayanSort {
 					}
 				}
 
-				int left = start + index - 1;
+				Size left = start + index - 1;
 				if (left < start + length) {
 					array[left - 2] = std::move(array[left]);
 				}
@@ -290,13 +295,27 @@ namespace MayanSort {
 			// "scrolling buffer" + array[start, middle - 1] + array[middle, end - 1]
 			// --> array[buffer, buffer + end - 1] + "scrolling buffer"
 			template<typename RandomAccessIterator, typename Compare>
-			static void MergeForwards(RandomAccessIterator array, int start, int leftLen, int rightLen, int bufferOffset, Compare comp) {
+			static void MergeForwards(RandomAccessIterator array, Size start, Size leftLen, Size rightLen, Size bufferOffset, Compare comp) {
 				auto buffer = array + (start - bufferOffset);
 				auto left = array + start;
 				auto middle = array + (start + leftLen);
 				auto right = middle;
 				auto end = middle + rightLen;
 
+				using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				if constexpr (_simd::branchless_merge<value_type, decltype(comp.compare)>) {
+					// While both sides are left, select the element to swap without branching.
+					while (left != middle && right != end) {
+						value_type const l = *left, r = *right, b = *buffer;
+						bool const takeRight = comp.compare(r, l);
+						*buffer = takeRight ? r : l;
+						*(takeRight ? right : left) = b;
+						right += takeRight;
+						left += !takeRight;
+						++buffer;
+					}
+				}
+
 				while (right != end) {
 					if (left == middle || comp(*left, *right) > 0) {
 						std::iter_swap(buffer, right);
@@ -316,16 +335,16 @@ namespace MayanSort {
 
 			// credit to 666666t for thorough bug-checking/fixing
 			template<typename RandomAccessIterator, typename Compare>
-			static void MergeBackwards(RandomAccessIterator array, int start, int leftLen, int rightLen, int bufferOffset, Compare comp) {
+			static void MergeBackwards(RandomAccessIterator array, Size start, Size leftLen, Size rightLen, Size bufferOffset, Compare comp) {
 				// used to be '= start'
-				int    end = start - 1;
+				Size    end = start - 1;
 				// used to be '= start + leftLen - 1'
-				int   left = end + leftLen;
-				int middle = left;
+				Size   left = end + leftLen;
+				Size middle = left;
 				// OFF-BY-ONE BUG FIXED: used to be `int  right = middle + rightLen - 1;`
-				int  right = middle + rightLen;
+				Size  right = middle + rightLen;
 				// OFF-BY-ONE BUG FIXED: used to be `int buffer = right  + bufferOffset - 1;`
-				int buffer = right + bufferOffset;
+				Size buffer = right + bufferOffset;
 
 				// used to be 'left >= end'
 				while (left > end) {
@@ -357,12 +376,25 @@ namespace MayanSort {
 			//
 			// FUNCTION RENAMED: More consistent with "out-of-place" being at the end
 			template<typename RandomAccessIterator, typename Compare>
-			static void MergeOutOfPlace(RandomAccessIterator array, int start, int leftLen, int rightLen, int bufferOffset, Compare comp) {
-				int buffer = start - bufferOffset;
-				int   left = start;
-				int middle = start + leftLen;
-				int  right = middle;
-				int    end = middle + rightLen;
+			static void MergeOutOfPlace(RandomAccessIterator array, Size start, Size leftLen, Size rightLen, Size bufferOffset, Compare comp) {
+				Size buffer = start - bufferOffset;
+				Size   left = start;
+				Size middle = start + leftLen;
+				Size  right = middle;
+				Size    end = middle + rightLen;
+
+				using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				if constexpr (_simd::branchless_merge<value_type, decltype(comp.compare)>) {
+					// While both sides are left, select the element to move without branching.
+					while (left < middle && right < end) {
+						value_type const l = array[left], r = array[right];
+						bool const takeRight = comp.compare(r, l);
+						array[buffer] = takeRight ? r : l;
+						right += takeRight;
+						left += !takeRight;
+						buffer++;
+					}
+				}
 
 				while (right < end) {
 					if (left == middle || comp(array[left], array[right]) > 0) {
@@ -386,19 +418,19 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			static void BuildInPlace(RandomAccessIterator array, int start, int length, int currentLen, int bufferLen, Compare comp) {
-				for (int mergeLen = currentLen; mergeLen < bufferLen; mergeLen *= 2) {
-					int fullMerge = 2 * mergeLen;
+			static void BuildInPlace(RandomAccessIterator array, Size start, Size length, Size currentLen, Size bufferLen, Compare comp) {
+				for (Size mergeLen = currentLen; mergeLen < bufferLen; mergeLen *= 2) {
+					Size fullMerge = 2 * mergeLen;
 
-					int mergeIndex;
-					int mergeEnd = start + length - fullMerge;
-					int bufferOffset = mergeLen;
+					Size mergeIndex;
+					Size mergeEnd = start + length - fullMerge;
+					Size bufferOffset = mergeLen;
 
 					for (mergeIndex = start; mergeIndex <= mergeEnd; mergeIndex += fullMerge) {
 						MergeForwards(array, mergeIndex, mergeLen, mergeLen, bufferOffset, comp);
 					}
 
-					int leftOver = length - (mergeIndex - start);
+					Size leftOver = length - (mergeIndex - start);
 
 					if (leftOver > mergeLen) {
 						MergeForwards(array, mergeIndex, mergeLen, leftOver - mergeLen, bufferOffset, comp);
@@ -410,9 +442,9 @@ namespace MayanSort {
 					start -= mergeLen;
 				}
 
-				int fullMerge = 2 * bufferLen;
-				int lastBlock = length % fullMerge;
-				int lastOffset = start + length - lastBlock;
+				Size fullMerge = 2 * bufferLen;
+				Size lastBlock = length % fullMerge;
+				Size lastOffset = start + length - lastBlock;
 
 				if (lastBlock <= bufferLen) {
 					Rotate(array, lastOffset, lastBlock, bufferLen);
@@ -421,32 +453,32 @@ namespace MayanSort {
 					MergeBackwards(array, lastOffset, bufferLen, lastBlock - bufferLen, bufferLen, comp);
 				}
 
-				for (int mergeIndex = lastOffset - fullMerge; mergeIndex >= start; mergeIndex -= fullMerge) {
+				for (Size mergeIndex = lastOffset - fullMerge; mergeIndex >= start; mergeIndex -= fullMerge) {
 					MergeBackwards(array, mergeIndex, bufferLen, bufferLen, bufferLen, comp);
 				}
 			}
 
 			template<typename RandomAccessIterator, typename BufferIterator, typename Compare>
-			void BuildOutOfPlace(RandomAccessIterator array, int start, int length, int bufferLen, int extLen,
+			void BuildOutOfPlace(RandomAccessIterator array, Size start, Size length, Size bufferLen, Size extLen,
 				BufferIterator extBuffer, Compare comp) {
 				std::move(array + (start - extLen), array + start, extBuffer);
 
 				PairwiseWrites(array, start, length, comp);
 				start -= 2;
 
-				int mergeLen;
+				Size mergeLen;
 				for (mergeLen = 2; mergeLen < extLen; mergeLen *= 2) {
-					int fullMerge = 2 * mergeLen;
+					Size fullMerge = 2 * mergeLen;
 
-					int mergeIndex;
-					int mergeEnd = start + length - fullMerge;
-					int bufferOffset = mergeLen;
+					Size mergeIndex;
+					Size mergeEnd = start + length - fullMerge;
+					Size bufferOffset = mergeLen;
 
 					for (mergeIndex = start; mergeIndex <= mergeEnd; mergeIndex += fullMerge) {
 						MergeOutOfPlace(array, mergeIndex, mergeLen, mergeLen, bufferOffset, comp);
 					}
 
-					int leftOver = length - (mergeIndex - start);
+					Size leftOver = length - (mergeIndex - start);
 
 					if (leftOver > mergeLen) {
 						MergeOutOfPlace(array, mergeIndex, mergeLen, leftOver - mergeLen, bufferOffset, comp);
@@ -467,10 +499,10 @@ namespace MayanSort {
 			// input: [start - mergeLen, start - 1] elements are buffer
 			// output: first 'bufferLen' elements are buffer, blocks (2 * bufferLen) and last subblock sorted
 			template<typename RandomAccessIterator, typename BufferIterator, typename Compare>
-			void BuildBlocks(RandomAccessIterator array, int start, int length, int bufferLen,
-				BufferIterator extBuffer, int extBufferLen, Compare comp) {
+			void BuildBlocks(RandomAccessIterator array, Size start, Size length, Size bufferLen,
+				BufferIterator extBuffer, Size extBufferLen, Compare comp) {
 				if (extBufferLen != 0) {
-					int extLen;
+					Size extLen;
 
 					if (bufferLen < extBufferLen) {
 						extLen = bufferLen;
@@ -493,11 +525,11 @@ namespace MayanSort {
 
 			// Returns the final position of 'medianKey'
 			template<typename RandomAccessIterator, typename Compare>
-			static int BlockSelectSort(RandomAccessIterator array, int firstKey, int start, int medianKey, int blockCount, int blockLen, Compare comp) {
-				for (int firstBlock = 0; firstBlock < blockCount; firstBlock++) {
-					int selectBlock = firstBlock;
+			static Size BlockSelectSort(RandomAccessIterator array, Size firstKey, Size start, Size medianKey, Size blockCount, Size blockLen, Compare comp) {
+				for (Size firstBlock = 0; firstBlock < blockCount; firstBlock++) {
+					Size selectBlock = firstBlock;
 
-					for (int currBlock = firstBlock + 1; currBlock < blockCount; currBlock++) {
+					for (Size currBlock = firstBlock + 1; currBlock < blockCount; currBlock++) {
 						int compare = comp(array[start + (currBlock * blockLen)],
 							array[start + (selectBlock * blockLen)]);
 
@@ -536,9 +568,9 @@ namespace MayanSort {
 			// OFF-BY-ONE BUG FIXED: used to be `int index = start + resetLen`; credit to 666666t for debugging
 			// RESTRUCTED, BETTER NAMES: 'resetLen' is now 'length' and 'bufferLen' is now 'bufferOffset'
 			template<typename RandomAccessIterator>
-			static void InPlaceBufferReset(RandomAccessIterator array, int start, int length, int bufferOffset) {
-				int  index = start + length - 1;
-				int buffer = index - bufferOffset;
+			static void InPlaceBufferReset(RandomAccessIterator array, Size start, Size length, Size bufferOffset) {
+				Size  index = start + length - 1;
+				Size buffer = index - bufferOffset;
 
 				while (index >= start) {
 					std::swap(array[index], array[buffer]);
@@ -554,9 +586,9 @@ namespace MayanSort {
 			// OFF-BY-ONE BUG FIXED: used to be `int index = start + resetLen`; credit to 666666t for debugging
 			// RESTRUCTED, BETTER NAMES: 'resetLen' is now 'length' and 'bufferLen' is now 'bufferOffset'
 			template<typename RandomAccessIterator>
-			static void OutOfPlaceBufferReset(RandomAccessIterator array, int start, int length, int bufferOffset) {
-				int  index = start + length - 1;
-				int buffer = index - bufferOffset;
+			static void OutOfPlaceBufferReset(RandomAccessIterator array, Size start, Size length, Size bufferOffset) {
+				Size  index = start + length - 1;
+				Size buffer = index - bufferOffset;
 
 				while (index >= start) {
 					array[index] = std::move(array[buffer]);
@@ -573,7 +605,7 @@ namespace MayanSort {
 			// BETTER ORDER-OF-OPERATIONS, NAMING IMPROVED: the left over items (now called 'leftBlock') are in the
 			//                                              middle of the merge while the buffer is at the end
 			template<typename RandomAccessIterator>
-			static void InPlaceBufferRewind(RandomAccessIterator array, int start, int leftBlock, int buffer) {
+			static void InPlaceBufferRewind(RandomAccessIterator array, Size start, Size leftBlock, Size buffer) {
 				while (leftBlock >= start) {
 					std::swap(array[buffer], array[leftBlock]);
 					leftBlock--;
@@ -589,7 +621,7 @@ namespace MayanSort {
 			// BETTER ORDER, INCORRECT ORDER OF PARAMETERS BUG FIXED: `leftOvers` (now called 'leftBlock') should be
 			//                                                        the middle, and `buffer` should be the end
 			template<typename RandomAccessIterator>
-			static void OutOfPlaceBufferRewind(RandomAccessIterator array, int start, int leftBlock, int buffer) {
+			static void OutOfPlaceBufferRewind(RandomAccessIterator array, Size start, Size leftBlock, Size buffer) {
 				while (leftBlock >= start) {
 					array[buffer] = std::move(array[leftBlock]);
 					leftBlock--;
@@ -598,7 +630,7 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			static Subarray GetSubarray(RandomAccessIterator array, int currKey, int medianKey, Compare comp) {
+			static Subarray GetSubarray(RandomAccessIterator array, Size currKey, Size medianKey, Compare comp) {
 				if (comp(array[currKey], array[medianKey]) < 0) {
 					return Subarray::LEFT;
 				}
@@ -609,11 +641,11 @@ namespace MayanSort {
 
 			// FUNCTION RE-RENAMED: last/final left blocks are used to calculate the length of the final merge
 			template<typename RandomAccessIterator, typename Compare>
-			static int CountLastMergeBlocks(RandomAccessIterator array, int offset, int blockCount, int blockLen, Compare comp) {
-				int blocksToMerge = 0;
+			static Size CountLastMergeBlocks(RandomAccessIterator array, Size offset, Size blockCount, Size blockLen, Compare comp) {
+				Size blocksToMerge = 0;
 
-				int lastRightFrag = offset + (blockCount * blockLen);
-				int   prevLeftBlock = lastRightFrag - blockLen;
+				Size lastRightFrag = offset + (blockCount * blockLen);
+				Size   prevLeftBlock = lastRightFrag - blockLen;
 
 				while (blocksToMerge < blockCount && comp(array[lastRightFrag], array[prevLeftBlock]) < 0) {
 					blocksToMerge++;
@@ -624,7 +656,7 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			void SmartMerge(RandomAccessIterator array, int start, int leftLen, Subarray leftOrigin, int rightLen, int bufferOffset, Compare comp) {
+			void SmartMerge(RandomAccessIterator array, Size start, Size leftLen, Subarray leftOrigin, Size rightLen, Size bufferOffset, Compare comp) {
 				auto buffer = array + (start - bufferOffset);
 				auto left = array + start;
 				auto middle = left + leftLen;
@@ -676,13 +708,13 @@ namespace MayanSort {
 
 			// MINOR CHANGE: better naming -- 'insertPos' is now 'mergeLen' -- and "middle" calculation simplified
 			template<typename RandomAccessIterator, typename Compare>
-			void SmartLazyMerge(RandomAccessIterator array, int start, int leftLen, Subarray leftOrigin, int rightLen, Compare comp) {
-				int middle = start + leftLen;
+			void SmartLazyMerge(RandomAccessIterator array, Size start, Size leftLen, Subarray leftOrigin, Size rightLen, Compare comp) {
+				Size middle = start + leftLen;
 
 				if (leftOrigin == Subarray::LEFT) {
 					if (comp(array[middle - 1], array[middle]) > 0) {
 						while (leftLen != 0) {
-							int mergeLen = BinarySearchLeft(array, middle, rightLen, array[start], comp);
+							Size mergeLen = BinarySearchLeft(array, middle, rightLen, array[start], comp);
 
 							if (mergeLen != 0) {
 								Rotate(array, start, leftLen, mergeLen);
@@ -708,7 +740,7 @@ namespace MayanSort {
 				else {
 					if (comp(array[middle - 1], array[middle]) >= 0) {
 						while (leftLen != 0) {
-							int mergeLen = BinarySearchRight(array, start + leftLen, rightLen, array[start], comp);
+							Size mergeLen = BinarySearchRight(array, start + leftLen, rightLen, array[start], comp);
 
 							if (mergeLen != 0) {
 								Rotate(array, start, leftLen, mergeLen);
@@ -743,12 +775,12 @@ namespace MayanSort {
 
 			// FUNCTION RENAMED: more consistent with other "out-of-place" merges
 			template<typename RandomAccessIterator, typename Compare>
-			void SmartMergeOutOfPlace(RandomAccessIterator array, int start, int leftLen, Subarray leftOrigin, int rightLen, int bufferOffset, Compare comp) {
-				int buffer = start - bufferOffset;
-				int   left = start;
-				int middle = start + leftLen;
-				int  right = middle;
-				int    end = middle + rightLen;
+			void SmartMergeOutOfPlace(RandomAccessIterator array, Size start, Size leftLen, Subarray leftOrigin, Size rightLen, Size bufferOffset, Compare comp) {
+				Size buffer = start - bufferOffset;
+				Size   left = start;
+				Size middle = start + leftLen;
+				Size  right = middle;
+				Size    end = middle + rightLen;
 
 				if (leftOrigin == Subarray::LEFT) {
 					while (left < middle && right < end) {
@@ -796,18 +828,18 @@ namespace MayanSort {
 			// Credit to Anonymous0726 for better variable names such as "nextBlock"
 			// Also minor change: removed unnecessary "currBlock = nextBlock" lines
 			template<typename RandomAccessIterator, typename Compare>
-			void MergeBlocks(RandomAccessIterator array, int firstKey, int medianKey, int start, int blockCount, int blockLen,
-				int lastMergeBlocks, int lastLen, Compare comp) {
-				int buffer;
+			void MergeBlocks(RandomAccessIterator array, Size firstKey, Size medianKey, Size start, Size blockCount, Size blockLen,
+				Size lastMergeBlocks, Size lastLen, Compare comp) {
+				Size buffer;
 
-				int currBlock;
-				int nextBlock = start + blockLen;
+				Size currBlock;
+				Size nextBlock = start + blockLen;
 
 				this->currBlockLen = blockLen;
 				this->currBlockOrigin = GetSubarray(array, firstKey, medianKey, comp);
 
 				Subarray nextBlockOrigin;
-				for (int keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
+				for (Size keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
 					currBlock = nextBlock - this->currBlockLen;
 					nextBlockOrigin = GetSubarray(array, firstKey + keyIndex, medianKey, comp);
 
@@ -845,16 +877,16 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			void LazyMergeBlocks(RandomAccessIterator array, int firstKey, int medianKey, int start, int blockCount, int blockLen,
-				int lastMergeBlocks, int lastLen, Compare comp) {
-				int currBlock;
-				int nextBlock = start + blockLen;
+			void LazyMergeBlocks(RandomAccessIterator array, Size firstKey, Size medianKey, Size start, Size blockCount, Size blockLen,
+				Size lastMergeBlocks, Size lastLen, Compare comp) {
+				Size currBlock;
+				Size nextBlock = start + blockLen;
 
 				this->currBlockLen = blockLen;
 				this->currBlockOrigin = GetSubarray(array, firstKey, medianKey, comp);
 
 				Subarray nextBlockOrigin;
-				for (int keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
+				for (Size keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
 					currBlock = nextBlock - this->currBlockLen;
 
 					nextBlockOrigin = GetSubarray(array, firstKey + keyIndex, medianKey, comp);
@@ -887,17 +919,17 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			void MergeBlocksOutOfPlace(RandomAccessIterator array, int firstKey, int medianKey, int start, int blockCount, int blockLen,
-				int lastMergeBlocks, int lastLen, Compare comp) {
-				int buffer;
-				int currBlock;
-				int nextBlock = start + blockLen;
+			void MergeBlocksOutOfPlace(RandomAccessIterator array, Size firstKey, Size medianKey, Size start, Size blockCount, Size blockLen,
+				Size lastMergeBlocks, Size lastLen, Compare comp) {
+				Size buffer;
+				Size currBlock;
+				Size nextBlock = start + blockLen;
 
 				this->currBlockLen = blockLen;
 				this->currBlockOrigin = GetSubarray(array, firstKey, medianKey, comp);
 
 				Subarray nextBlockOrigin;
-				for (int keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
+				for (Size keyIndex = 1; keyIndex < blockCount; keyIndex++, nextBlock += blockLen) {
 					currBlock = nextBlock - this->currBlockLen;
 					nextBlockOrigin = GetSubarray(array, firstKey + keyIndex, medianKey, comp);
 
@@ -934,19 +966,19 @@ namespace MayanSort {
 
 			//TODO: Double-check "Merge Blocks" arguments
 			template<typename RandomAccessIterator, typename Compare>
-			void CombineInPlace(RandomAccessIterator array, int firstKey, int start, int length, int subarrayLen, int blockLen,
-				int mergeCount, int lastSubarrays, bool buffer, Compare comp) {
-				int fullMerge = 2 * subarrayLen;
+			void CombineInPlace(RandomAccessIterator array, Size firstKey, Size start, Size length, Size subarrayLen, Size blockLen,
+				Size mergeCount, Size lastSubarrays, bool buffer, Compare comp) {
+				Size fullMerge = 2 * subarrayLen;
 				// SLIGHT OPTIMIZATION: 'blockCount' only needs to be calculated once for regular merges
-				int blockCount = fullMerge / blockLen;
+				Size blockCount = fullMerge / blockLen;
 
-				for (int mergeIndex = 0; mergeIndex < mergeCount; mergeIndex++) {
-					int offset = start + (mergeIndex * fullMerge);
+				for (Size mergeIndex = 0; mergeIndex < mergeCount; mergeIndex++) {
+					Size offset = start + (mergeIndex * fullMerge);
 
 					InsertSort(array, firstKey, blockCount, comp);
 
 					// INCORRECT PARAMETER BUG FIXED: `block select sort` should be using `offset`, not `start`
-					int medianKey = subarrayLen / blockLen;
+					Size medianKey = subarrayLen / blockLen;
 					medianKey = BlockSelectSort(array, firstKey, offset, medianKey, blockCount, blockLen, comp);
 
 					if (buffer) {
@@ -959,19 +991,19 @@ namespace MayanSort {
 
 				// INCORRECT CONDITIONAL/PARAMETER BUG FIXED: Credit to 666666t for debugging.
 				if (lastSubarrays != 0) {
-					int offset = start + (mergeCount * fullMerge);
+					Size offset = start + (mergeCount * fullMerge);
 					blockCount = lastSubarrays / blockLen;
 
 					InsertSort(array, firstKey, blockCount + 1, comp);
 
 					// INCORRECT PARAMETER BUG FIXED: `block select sort` should be using `offset`, not `start`
-					int medianKey = subarrayLen / blockLen;
+					Size medianKey = subarrayLen / blockLen;
 					medianKey = BlockSelectSort(array, firstKey, offset, medianKey, blockCount, blockLen, comp);
 
 					// MISSING BOUNDS CHECK BUG FIXED: `lastFragment` *can* be 0 if the last two subarrays are evenly
 					//                                 divided into blocks. This prevents Grailsort from going out-of-bounds.
-					int lastFragment = lastSubarrays - (blockCount * blockLen);
-					int lastMergeBlocks;
+					Size lastFragment = lastSubarrays - (blockCount * blockLen);
+					Size lastMergeBlocks;
 					if (lastFragment != 0) {
 						lastMergeBlocks = CountLastMergeBlocks(array, offset, blockCount, blockLen, comp);
 					}
@@ -979,11 +1011,11 @@ namespace MayanSort {
 						lastMergeBlocks = 0;
 					}
 
-					int smartMerges = blockCount - lastMergeBlocks;
+					Size smartMerges = blockCount - lastMergeBlocks;
 
 					//TODO: Double-check if this micro-optimization works correctly like the original
 					if (smartMerges == 0) {
-						int leftLen = lastMergeBlocks * blockLen;
+						Size leftLen = lastMergeBlocks * blockLen;
 
 						// INCORRECT PARAMETER BUG FIXED: these merges should be using `offset`, not `start`
 						if (buffer) {
@@ -1011,21 +1043,21 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename BufferIterator, typename Compare>
-			void CombineOutOfPlace(RandomAccessIterator array, int firstKey, int start, int length, int subarrayLen, int blockLen,
-				int mergeCount, int lastSubarrays, BufferIterator extBuffer, int extBufferLen, Compare comp) {
+			void CombineOutOfPlace(RandomAccessIterator array, Size firstKey, Size start, Size length, Size subarrayLen, Size blockLen,
+				Size mergeCount, Size lastSubarrays, BufferIterator extBuffer, Size extBufferLen, Compare comp) {
 				std::move(array + (start - blockLen), array + start, extBuffer);
 
-				int fullMerge = 2 * subarrayLen;
+				Size fullMerge = 2 * subarrayLen;
 				// SLIGHT OPTIMIZATION: 'blockCount' only needs to be calculated once for regular merges
-				int blockCount = fullMerge / blockLen;
+				Size blockCount = fullMerge / blockLen;
 
-				for (int mergeIndex = 0; mergeIndex < mergeCount; mergeIndex++) {
-					int offset = start + (mergeIndex * fullMerge);
+				for (Size mergeIndex = 0; mergeIndex < mergeCount; mergeIndex++) {
+					Size offset = start + (mergeIndex * fullMerge);
 
 					InsertSort(array, firstKey, blockCount, comp);
 
 					// INCORRECT PARAMETER BUG FIXED: `block select sort` should be using `offset`, not `start`
-					int medianKey = subarrayLen / blockLen;
+					Size medianKey = subarrayLen / blockLen;
 					medianKey = BlockSelectSort(array, firstKey, offset, medianKey, blockCount, blockLen, comp);
 
 					MergeBlocksOutOfPlace(array, firstKey, firstKey + medianKey, offset,
@@ -1034,19 +1066,19 @@ namespace MayanSort {
 
 				// INCORRECT CONDITIONAL/PARAMETER BUG FIXED: Credit to 666666t for debugging.
 				if (lastSubarrays != 0) {
-					int offset = start + (mergeCount * fullMerge);
+					Size offset = start + (mergeCount * fullMerge);
 					blockCount = lastSubarrays / blockLen;
 
 					InsertSort(array, firstKey, blockCount + 1, comp);
 
 					// INCORRECT PARAMETER BUG FIXED: `block select sort` should be using `offset`, not `start`
-					int medianKey = subarrayLen / blockLen;
+					Size medianKey = subarrayLen / blockLen;
 					medianKey = BlockSelectSort(array, firstKey, offset, medianKey, blockCount, blockLen, comp);
 
 					// MISSING BOUNDS CHECK BUG FIXED: `lastFragment` *can* be 0 if the last two subarrays are evenly
 					//                                 divided into blocks. This prevents Grailsort from going out-of-bounds.
-					int lastFragment = lastSubarrays - (blockCount * blockLen);
-					int lastMergeBlocks;
+					Size lastFragment = lastSubarrays - (blockCount * blockLen);
+					Size lastMergeBlocks;
 					if (lastFragment != 0) {
 						lastMergeBlocks = CountLastMergeBlocks(array, offset, blockCount, blockLen, comp);
 					}
@@ -1054,11 +1086,11 @@ namespace MayanSort {
 						lastMergeBlocks = 0;
 					}
 
-					int smartMerges = blockCount - lastMergeBlocks;
+					Size smartMerges = blockCount - lastMergeBlocks;
 
 					if (smartMerges == 0) {
 						// MINOR CHANGE: renamed for consistency (used to be 'leftLength')
-						int leftLen = lastMergeBlocks * blockLen;
+						Size leftLen = lastMergeBlocks * blockLen;
 
 						// INCORRECT PARAMETER BUG FIXED: this merge should be using `offset`, not `start`
 						MergeOutOfPlace(array, offset, leftLen, lastFragment, blockLen, comp);
@@ -1082,11 +1114,11 @@ namespace MayanSort {
 			//                    *Please also check everything surrounding 'if(lastSubarrays != 0)' inside
 			//                    'combine in-/out-of-place' methods for other renames!!*
 			template<typename RandomAccessIterator, typename BufferIterator, typename Compare>
-			void CombineBlocks(RandomAccessIterator array, int firstKey, int start, int length, int subarrayLen, int blockLen,
-				bool buffer, BufferIterator extBuffer, int extBufferLen, Compare comp) {
-				int    fullMerge = 2 * subarrayLen;
-				int   mergeCount = length / fullMerge;
-				int lastSubarrays = length - (fullMerge * mergeCount);
+			void CombineBlocks(RandomAccessIterator array, Size firstKey, Size start, Size length, Size subarrayLen, Size blockLen,
+				bool buffer, BufferIterator extBuffer, Size extBufferLen, Compare comp) {
+				Size    fullMerge = 2 * subarrayLen;
+				Size   mergeCount = length / fullMerge;
+				Size lastSubarrays = length - (fullMerge * mergeCount);
 
 				if (lastSubarrays <= subarrayLen) {
 					length -= lastSubarrays;
@@ -1110,12 +1142,12 @@ namespace MayanSort {
 			// cost: min(leftLen, rightLen)^2 + max(leftLen, rightLen)
 			// MINOR CHANGES: better naming -- 'insertPos' is now 'mergeLen' -- and "middle"/"end" calculations simplified
 			template<typename RandomAccessIterator, typename Compare>
-			static void LazyMerge(RandomAccessIterator array, int start, int leftLen, int rightLen, Compare comp) {
+			static void LazyMerge(RandomAccessIterator array, Size start, Size leftLen, Size rightLen, Compare comp) {
 				if (leftLen < rightLen) {
-					int middle = start + leftLen;
+					Size middle = start + leftLen;
 
 					while (leftLen != 0) {
-						int mergeLen = BinarySearchLeft(array, middle, rightLen, array[start], comp);
+						Size mergeLen = BinarySearchLeft(array, middle, rightLen, array[start], comp);
 
 						if (mergeLen != 0) {
 							Rotate(array, start, leftLen, mergeLen);
@@ -1138,11 +1170,11 @@ namespace MayanSort {
 				}
 				// INDEXING BUG FIXED: Credit to Anonymous0726 for debugging.
 				else {
-					int end = start + leftLen + rightLen - 1;
+					Size end = start + leftLen + rightLen - 1;
 
 
 					while (rightLen != 0) {
-						int mergeLen = BinarySearchRight(array, start, leftLen, array[end], comp);
+						Size mergeLen = BinarySearchRight(array, start, leftLen, array[end], comp);
 
 						if (mergeLen != leftLen) {
 							Rotate(array, start + mergeLen, leftLen - mergeLen, rightLen);
@@ -1154,7 +1186,7 @@ namespace MayanSort {
 							break;
 						}
 						else {
-							int middle = start + leftLen;
+							Size middle = start + leftLen;
 							do {
 								rightLen--;
 								end--;
@@ -1165,26 +1197,26 @@ namespace MayanSort {
 			}
 
 			template<typename RandomAccessIterator, typename Compare>
-			static void LazyStableSort(RandomAccessIterator array, int start, int length, Compare comp) {
-				for (int index = 1; index < length; index += 2) {
-					int  left = start + index - 1;
-					int right = start + index;
+			static void LazyStableSort(RandomAccessIterator array, Size start, Size length, Compare comp) {
+				for (Size index = 1; index < length; index += 2) {
+					Size  left = start + index - 1;
+					Size right = start + index;
 
 					if (comp(array[left], array[right]) > 0) {
 						std::swap(array[left], array[right]);
 					}
 				}
-				for (int mergeLen = 2; mergeLen < length; mergeLen *= 2) {
-					int fullMerge = 2 * mergeLen;
+				for (Size mergeLen = 2; mergeLen < length; mergeLen *= 2) {
+					Size fullMerge = 2 * mergeLen;
 
-					int mergeIndex;
-					int mergeEnd = length - fullMerge;
+					Size mergeIndex;
+					Size mergeEnd = length - fullMerge;
 
 					for (mergeIndex = 0; mergeIndex <= mergeEnd; mergeIndex += fullMerge) {
 						LazyMerge(array, start + mergeIndex, mergeLen, mergeLen, comp);
 					}
 
-					int leftOver = length - mergeIndex;
+					Size leftOver = length - mergeIndex;
 					if (leftOver > mergeLen) {
 						LazyMerge(array, start + mergeIndex, mergeLen, leftOver - mergeLen, comp);
 					}
@@ -1207,16 +1239,17 @@ namespace MayanSort {
 			}*/
 
 			template<typename RandomAccessIterator, typename BufferIterator, typename Compare>
-			void CommonSort(RandomAccessIterator array, int start, int length, BufferIterator extBuf, int extBufLen, Compare comp) {
+			void CommonSort(RandomAccessIterator array, Size start, Size length, BufferIterator extBuf, Size extBufLen, Compare comp) {
+				_TracePhase("grailsort", length);
 				if (length < 16) {
 					InsertSort(array, start, length, comp);
 					return;
 				}
 
 				BufferIterator extBuffer{};
-				int extBufferLen;
+				Size extBufferLen = 0;
 
-				int blockLen = 1;
+				Size blockLen = 1;
 
 				// find the smallest power of two greater than or equal to
 				// the square root of the input's length
@@ -1228,20 +1261,25 @@ namespace MayanSort {
 				// formula for the ceiling of (a / b)
 				//
 				// credit to Anonymous0726 for figuring this out!
-				int keyLen = ((length - 1) / blockLen) + 1;
+				Size keyLen = ((length - 1) / blockLen) + 1;
 
 				// Grailsort is hoping to find `2 * sqrt(n)` unique items
 				// throughout the array
-				int idealKeys = keyLen + blockLen;
+				Size idealKeys = keyLen + blockLen;
 
 				//TODO: Clean up `start +` offsets
-				int keysFound = CollectKeys(array, start, length, idealKeys, comp);
+				Size keysFound;
+				{
+					_TracePhase("grailsort.collect_keys", length);
+					keysFound = CollectKeys(array, start, length, idealKeys, comp);
+				}
 
 				bool idealBuffer;
 				if (keysFound < idealKeys) {
 					if (keysFound == 1) return;
 					if (keysFound < 4) {
 						// GRAILSORT STRATEGY 3 -- No block swaps or scrolling buffer; resort to Lazy Stable Sort
+						_TracePhase("grailsort.lazy_stable_sort", length);
 						LazyStableSort(array, start, length, comp);
 						return;
 					}
@@ -1261,8 +1299,8 @@ namespace MayanSort {
 					idealBuffer = true;
 				}
 
-				int bufferEnd = blockLen + keyLen;
-				int subarrayLen;
+				Size bufferEnd = blockLen + keyLen;
+				Size subarrayLen;
 				if (idealBuffer) {
 					subarrayLen = blockLen;
 				}
@@ -1276,19 +1314,22 @@ namespace MayanSort {
 					extBufferLen = extBufLen;
 				}
 
-				BuildBlocks(array, start + bufferEnd, length - bufferEnd, subarrayLen,
-					extBuffer, extBufferLen, comp);
+				{
+					_TracePhase("grailsort.build_blocks", length - bufferEnd);
+					BuildBlocks(array, start + bufferEnd, length - bufferEnd, subarrayLen,
+						extBuffer, extBufferLen, comp);
+				}
 
 				while ((length - bufferEnd) > (2 * subarrayLen)) {
 					subarrayLen *= 2;
 
-					int currBlockLen = blockLen;
+					Size currBlockLen = blockLen;
 					bool scrollingBuffer = idealBuffer;
 
 					// Huge credit to Anonymous0726, phoenixbound, and DeveloperSort for their tireless efforts
 					// towards deconstructing this math.
 					if (!idealBuffer) {
-						int keyBuffer = keyLen / 2;
+						Size keyBuffer = keyLen / 2;
 						// TODO: Rewrite explanation for this math
 						if (keyBuffer >= (2 * subarrayLen) / keyBuffer) {
 							currBlockLen = keyBuffer;
@@ -1312,11 +1353,14 @@ namespace MayanSort {
 
 					// WRONG VARIABLE BUG FIXED: 4th argument should be `length - bufferEnd`, was `length - bufferLen` before.
 					// Credit to 666666t and Anonymous0726 for debugging.
+					_TracePhase("grailsort.combine_blocks", length - bufferEnd);
 					CombineBlocks(array, start, start + bufferEnd, length - bufferEnd,
 						subarrayLen, currBlockLen, scrollingBuffer,
 						extBuffer, extBufferLen, comp);
 				}
 
+				// The keys and the buffer are sorted and merged back in.
+				_TracePhase("grailsort.final_merge", length);
 				InsertSort(array, start, bufferEnd, comp);
 				LazyMerge(array, start, bufferEnd, length - bufferEnd, comp);
 			}
@@ -1330,8 +1374,9 @@ namespace MayanSort {
 		void grailsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp = {})
 	{
 		using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+		using difference_type = typename std::iterator_traits<RandomAccessIterator>::difference_type;
 
-		grailsort_detail::GrailSort gsort;
+		grailsort_detail::GrailSort<difference_type> gsort;
 		gsort.CommonSort(first, 0, last - first,
 			(value_type*)nullptr, 0,
 			grailsort_detail::ThreeWayCompare<Compare>(std::move(comp)));
@@ -1346,7 +1391,9 @@ namespace MayanSort {
 			RandomAccessIterator2 buff_first, RandomAccessIterator2 buff_last,
 			Compare comp = {})
 	{
-		grailsort_detail::GrailSort gsort;
+		using difference_type = typename std::iterator_traits<RandomAccessIterator1>::difference_type;
+
+		grailsort_detail::GrailSort<difference_type> gsort;
 		gsort.CommonSort(first, 0, last - first,
 			buff_first, buff_last - buff_first,
 			grailsort_detail::ThreeWayCompare<Compare>(std::move(comp)));
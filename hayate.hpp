@@ -30,10 +30,13 @@
 
 
 
+#include <algorithm>
 #include <cstddef>
 #include <utility>
 #include <malloc.h>
 
+#include "mayanmem.hpp"
+
 #if _MSC_VER//[
 // msvc
 #define alloca      _alloca
@@ -94,32 +97,26 @@ namespace MayanSort {
 
 
             private:
-                bool mbTemporary;
+                _mem::buffer<val_t> mBuffer;    // Slots of a temporary array, none for a view.
                 dif_t mSize;
                 ptr_t mData;
 
 
 
             public:
-                ~Array() noexcept
-                {
-                    if (mbTemporary) ::operator delete(mData, std::nothrow);
-                }
-
-
-
                 Array(ForwardIterator first, ForwardIterator last)
-                    :mbTemporary(false)
-                    , mSize(std::distance(first, last))
+                    :mSize(std::distance(first, last))
                     , mData(&*first)
                 {}
 
 
 
-                Array(dif_t Size)
-                    :mbTemporary(true)
-                    , mSize(Size)
-                    , mData(static_cast<ptr_t>(::operator new(sizeof(val_t)* Size)))
+                // The elements are moved into the buffer by assignment, so its slots are primed
+                // from source (see _mem::buffer::prime()) and hold live elements until the
+                // buffer destroys them.
+                Array(dif_t Size, itr_t source)
+                    :mSize(Size)
+                    , mData(mBuffer.prime(source, std::size_t(Size)))
                 {}
 
 
@@ -237,6 +234,9 @@ namespace MayanSort {
 
                 itr_t Copy(itr_t iDst, itr_t iSrc, dif_t nSrc)
                 {
+                    // The rest of a join can already be in place, and moving an element onto
+                    // itself may leave it empty.
+                    if (iDst == iSrc) return iDst + nSrc;
                     while (nSrc--) *iDst++ = std::move(*iSrc++);
                     return iDst;
                 }
@@ -513,7 +513,7 @@ namespace MayanSort {
                 Technique(rai_t const first, rai_t const last, cmp_t comp)
                     :mnOriginal(std::distance(first, last))
                     , maOriginal(first, last)
-                    , maExternal(mnOriginal)
+                    , maExternal(mnOriginal, maOriginal.begin())
                     , mComp(comp)
                 {}
 
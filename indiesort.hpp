@@ -344,13 +344,13 @@ namespace MayanSort {
 
 
 
-		template <class iterator_type, class comparison_function, typename size_type>
-		PLF_CONSTFUNC void random_access_sort(const iterator_type first, comparison_function compare, const size_type size)
+		template <class iterator_type, class comparison_function, typename size_type, class allocator_type>
+		PLF_CONSTFUNC void random_access_sort(const iterator_type first, comparison_function compare, const size_type size, const allocator_type& allocator)
 		{
 			typedef typename plf::derive_type<plf::is_pointer<iterator_type>::value, iterator_type>::type	element_type;
-			typedef typename std::allocator<size_type> 																		size_type_allocator_type;
+			typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<size_type>		size_type_allocator_type;
 
-			size_type_allocator_type size_type_allocator;
+			size_type_allocator_type size_type_allocator(allocator);
 			size_type* const sort_array = PLF_ALLOCATE(size_type_allocator_type, size_type_allocator, size, NULL);
 			size_type* size_type_pointer = sort_array;
 
@@ -413,8 +413,8 @@ namespace MayanSort {
 
 
 
-		template <class iterator_type, class comparison_function>
-		PLF_CONSTFUNC void call_random_access_sort(const iterator_type first, const iterator_type last, comparison_function compare)
+		template <class iterator_type, class comparison_function, class allocator_type>
+		PLF_CONSTFUNC void call_random_access_sort(const iterator_type first, const iterator_type last, comparison_function compare, const allocator_type& allocator)
 		{
 			assert(first <= last);
 			const std::size_t size = static_cast<std::size_t>(last - first);
@@ -425,19 +425,19 @@ namespace MayanSort {
 			}
 			else if (size <= std::numeric_limits<unsigned char>::max())
 			{
-				plf::random_access_sort<iterator_type, comparison_function, unsigned char>(first, compare, static_cast<unsigned char>(size));
+				plf::random_access_sort<iterator_type, comparison_function, unsigned char>(first, compare, static_cast<unsigned char>(size), allocator);
 			}
 			else if (size <= std::numeric_limits<unsigned short>::max())
 			{
-				plf::random_access_sort<iterator_type, comparison_function, unsigned short>(first, compare, static_cast<unsigned short>(size));
+				plf::random_access_sort<iterator_type, comparison_function, unsigned short>(first, compare, static_cast<unsigned short>(size), allocator);
 			}
 			else if (size <= std::numeric_limits<unsigned int>::max())
 			{
-				plf::random_access_sort<iterator_type, comparison_function, unsigned int>(first, compare, static_cast<unsigned int>(size));
+				plf::random_access_sort<iterator_type, comparison_function, unsigned int>(first, compare, static_cast<unsigned int>(size), allocator);
 			}
 			else
 			{
-				plf::random_access_sort<iterator_type, comparison_function, std::size_t>(first, compare, size);
+				plf::random_access_sort<iterator_type, comparison_function, std::size_t>(first, compare, size, allocator);
 			}
 		}
 
@@ -476,8 +476,8 @@ namespace MayanSort {
 
 
 
-		template <class iterator_type, class comparison_function>
-		PLF_CONSTFUNC void non_random_access_sort(const iterator_type first, const iterator_type last, comparison_function compare, const std::size_t size)
+		template <class iterator_type, class comparison_function, class allocator_type>
+		PLF_CONSTFUNC void non_random_access_sort(const iterator_type first, const iterator_type last, comparison_function compare, const std::size_t size, const allocator_type& allocator)
 		{
 			if (size < 2)
 			{
@@ -488,8 +488,8 @@ namespace MayanSort {
 			typedef typename std::size_t																							size_type;
 			typedef plf::pointer_index_tuple<element_type*, size_type> 												item_index_tuple;
 
-			typedef typename std::allocator<item_index_tuple> tuple_allocator_type;
-			tuple_allocator_type tuple_allocator;
+			typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<item_index_tuple> tuple_allocator_type;
+			tuple_allocator_type tuple_allocator(allocator);
 
 			item_index_tuple* const sort_array = PLF_ALLOCATE(tuple_allocator_type, tuple_allocator, size, NULL);
 			item_index_tuple* tuple_pointer = sort_array;
@@ -561,7 +561,7 @@ namespace MayanSort {
 		template <class iterator_type, class comparison_function>
 		PLF_CONSTFUNC void indiesort(const iterator_type first, const iterator_type last, comparison_function compare, const std::size_t size)
 		{
-			plf::non_random_access_sort(first, last, compare, size);
+			plf::non_random_access_sort(first, last, compare, size, std::allocator<unsigned char>());
 		}
 
 
@@ -575,7 +575,7 @@ namespace MayanSort {
 		{
 			std::size_t size = 0;
 			for (iterator_type temp = first; temp != last; ++temp, ++size) {}
-			plf::non_random_access_sort(first, last, compare, size);
+			plf::non_random_access_sort(first, last, compare, size, std::allocator<unsigned char>());
 		}
 
 
@@ -587,7 +587,25 @@ namespace MayanSort {
 		PLF_CONSTFUNC void indiesort(const typename plf::enable_if<plf::is_pointer<iterator_type>::value, iterator_type>::type first, const iterator_type last, comparison_function compare)
 #endif
 		{
-			plf::call_random_access_sort(first, last, compare);
+			plf::call_random_access_sort(first, last, compare, std::allocator<unsigned char>());
+		}
+
+
+
+		// Same, with the index array taken from allocator, rebound to the index type:
+		template <class iterator_type, class comparison_function, class allocator_type, typename plf::enable_if<!std::is_integral<allocator_type>::value, allocator_type>::type* = nullptr>
+		PLF_CONSTFUNC void indiesort(const iterator_type first, const iterator_type last, comparison_function compare, const allocator_type& allocator)
+		{
+			if PLF_CONSTEXPR(plf::is_pointer<iterator_type>::value || std::is_same<typename std::iterator_traits<iterator_type>::iterator_category, std::random_access_iterator_tag>::value)
+			{
+				plf::call_random_access_sort(first, last, compare, allocator);
+			}
+			else
+			{
+				std::size_t size = 0;
+				for (iterator_type temp = first; temp != last; ++temp, ++size) {}
+				plf::non_random_access_sort(first, last, compare, size, allocator);
+			}
 		}
 
 
@@ -606,7 +624,7 @@ namespace MayanSort {
 		template <class container_type, class comparison_function, typename plf::enable_if<std::is_same<typename std::iterator_traits<typename container_type::iterator>::iterator_category, std::random_access_iterator_tag>::value, container_type>::type* = nullptr>
 		PLF_CONSTFUNC void indiesort(container_type& container, comparison_function compare)
 		{
-			plf::call_random_access_sort(container.begin(), container.end(), compare);
+			plf::call_random_access_sort(container.begin(), container.end(), compare, std::allocator<unsigned char>());
 		}
 #endif
 
@@ -640,7 +658,7 @@ namespace MayanSort {
 #ifdef PLF_DECLTYPE_SUPPORT
 			if PLF_CONSTEXPR(plf::has_size_function<container_type>::value)
 			{
-				plf::non_random_access_sort(container.begin(), container.end(), compare, static_cast<std::size_t>(container.size()));
+				plf::non_random_access_sort(container.begin(), container.end(), compare, static_cast<std::size_t>(container.size()), std::allocator<unsigned char>());
 			}
 			else
 #endif
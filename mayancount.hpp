@@ -0,0 +1,242 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// mayancount.hpp: Counting of comparisons, moves, swaps and allocations of one sort call.
+// CountSort() runs any sort of the library on a copy of a range whose elements and comparator
+// count what is done with them, and returns the counts of that call:
+//     SortCounts counts = MayanSort::CountSort(v.begin(), v.end(), comp,
+//         [](auto first, auto last, auto comp) { MayanSort::TimSort(first, last, comp); });
+// The counters of a call are atomic and travel with its elements and comparator, so parallel
+// sorts and concurrent calls on other threads count correctly. Nothing here is used by the
+// sorts themselves: the counting costs nothing when it is not asked for.
+// The counted elements are not arithmetic, so the sorts take their scalar paths, and the radix
+// sorts, which take no comparator, cannot be counted.
+
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MayanSort {
+
+	// What one sort call did. A swap through swap() or std::iter_swap() counts as one swap, a
+	// swap through std::swap() as three moves. Copies count as moves.
+	struct SortCounts {
+		std::uint64_t comparisons = 0;
+		std::uint64_t moves = 0;
+		std::uint64_t swaps = 0;
+		std::uint64_t allocations = 0;     // Only through the allocator of a sort, see CountSort().
+		std::uint64_t allocated_bytes = 0;
+	};
+
+	// Counters shared by the elements, comparator and allocator of a call.
+	class SortCounter {
+		std::atomic<std::uint64_t> comparisons_{ 0 }, moves_{ 0 }, swaps_{ 0 }, allocations_{ 0 }, bytes_{ 0 };
+
+	public:
+		void comparison() { comparisons_.fetch_add(1, std::memory_order_relaxed); }
+		void move() { moves_.fetch_add(1, std::memory_order_relaxed); }
+		void swap() { swaps_.fetch_add(1, std::memory_order_relaxed); }
+
+		void allocation(std::size_t bytes) {
+			allocations_.fetch_add(1, std::memory_order_relaxed);
+			bytes_.fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		SortCounts counts() const {
+			SortCounts c;
+			c.comparisons = comparisons_.load(std::memory_order_relaxed);
+			c.moves = moves_.load(std::memory_order_relaxed);
+			c.swaps = swaps_.load(std::memory_order_relaxed);
+			c.allocations = allocations_.load(std::memory_order_relaxed);
+			c.allocated_bytes = bytes_.load(std::memory_order_relaxed);
+			return c;
+		}
+	};
+
+	// The types are in their own namespace, so that argument-dependent lookup from the sorts
+	// finds no functions of MayanSort.
+	namespace _count {
+		// Element that counts its moves and swaps on the counter of the element it came from.
+		// Default-constructed ones, such as the slots of a scratch buffer, have no counter until they
+		// are assigned to.
+		template<typename T>
+		class Counted {
+			T value_;
+			SortCounter* counter_;
+
+			static void count_move(SortCounter* counter) {
+				if (counter) counter->move();
+			}
+
+		public:
+			Counted() : value_(), counter_(nullptr) {}
+			Counted(T value, SortCounter* counter) : value_(std::move(value)), counter_(counter) {}
+
+			Counted(const Counted& other) : value_(other.value_), counter_(other.counter_) {
+				count_move(counter_);
+			}
+
+			Counted(Counted&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+				: value_(std::move(other.value_)), counter_(other.counter_) {
+				count_move(counter_);
+			}
+
+			Counted& operator=(const Counted& other) {
+				value_ = other.value_;
+				counter_ = other.counter_;
+				count_move(counter_);
+				return *this;
+			}
+
+			Counted& operator=(Counted&& other) noexcept(std::is_nothrow_move_assignable_v<T>) {
+				value_ = std::move(other.value_);
+				counter_ = other.counter_;
+				count_move(counter_);
+				return *this;
+			}
+
+			// Only some sorts compare for equality, with the values' operator==.
+			friend bool operator==(const Counted& a, const Counted& b) {
+				if (SortCounter* counter = a.counter_ ? a.counter_ : b.counter_) counter->comparison();
+				return a.value_ == b.value_;
+			}
+
+			friend void swap(Counted& a, Counted& b) noexcept(std::is_nothrow_swappable_v<T>) {
+				using std::swap;
+				swap(a.value_, b.value_);
+				std::swap(a.counter_, b.counter_);
+				if (SortCounter* counter = a.counter_ ? a.counter_ : b.counter_) counter->swap();
+			}
+
+			const T& value() const { return value_; }
+			T& value() { return value_; }
+			SortCounter* counter() const { return counter_; }
+		};
+
+		// Comparator over Counted<T> that counts its calls and compares the values with comp.
+		template<typename Comp>
+		class CountingCompare {
+			mutable Comp comp_;
+			SortCounter* counter_;
+
+		public:
+			CountingCompare(Comp comp, SortCounter* counter) : comp_(std::move(comp)), counter_(counter) {}
+
+			template<typename T>
+			bool operator()(const Counted<T>& a, const Counted<T>& b) const {
+				counter_->comparison();
+				return comp_(a.value(), b.value());
+			}
+		};
+
+		// Allocator that counts the allocations made through it and takes them from Alloc.
+		template<typename T, typename Alloc = std::allocator<T> >
+		class CountingAllocator {
+			template<typename, typename>
+			friend class CountingAllocator;
+
+			typedef typename std::allocator_traits<Alloc>::template rebind_alloc<T> alloc_t;
+			typedef std::allocator_traits<alloc_t> traits;
+
+			alloc_t alloc_;
+			SortCounter* counter_;
+
+		public:
+			typedef T value_type;
+
+			template<typename U>
+			struct rebind {
+				typedef CountingAllocator<U, typename std::allocator_traits<Alloc>::template rebind_alloc<U> > other;
+			};
+
+			explicit CountingAllocator(SortCounter* counter, const Alloc& alloc = Alloc()) : alloc_(alloc), counter_(counter) {}
+
+			template<typename U, typename A>
+			CountingAllocator(const CountingAllocator<U, A>& other) : alloc_(other.alloc_), counter_(other.counter_) {}
+
+			T* allocate(std::size_t n) {
+				T* p = std::to_address(traits::allocate(alloc_, n));
+				counter_->allocation(n * sizeof(T));
+				return p;
+			}
+
+			void deallocate(T* p, std::size_t n) {
+				traits::deallocate(alloc_, p, n);
+			}
+
+			template<typename U, typename A>
+			bool operator==(const CountingAllocator<U, A>& other) const {
+				return counter_ == other.counter_ && alloc_ == alloc_t(other.alloc_);
+			}
+		};
+	}
+
+	using _count::Counted;
+	using _count::CountingCompare;
+	using _count::CountingAllocator;
+
+	// Sorts [first, last) with sort(first', last', comp') on counted copies of its elements, and
+	// returns the counts of that call. The elements are moved back sorted, outside of the counts.
+	// sort is also given a CountingAllocator as fourth argument when it takes one, which counts
+	// the scratch memory of the sorts that have allocator overloads.
+	template<typename It, typename Comp, typename Sort>
+		requires std::random_access_iterator<It>
+	SortCounts CountSort(It first, It last, Comp comp, Sort sort) {
+		typedef typename std::iterator_traits<It>::value_type T;
+		typedef typename std::vector<Counted<T> >::iterator CountedIt;
+		typedef CountingCompare<Comp> CountedComp;
+		typedef CountingAllocator<Counted<T> > CountedAlloc;
+
+		SortCounter counter;
+		std::vector<Counted<T> > counted;
+		counted.reserve(std::size_t(last - first));
+		for (It it = first; it != last; ++it) counted.emplace_back(std::move(*it), &counter);
+
+		CountedComp counted_comp(comp, &counter);
+		if constexpr (std::invocable<Sort&, CountedIt, CountedIt, CountedComp, CountedAlloc>)
+			sort(counted.begin(), counted.end(), counted_comp, CountedAlloc(&counter));
+		else
+			sort(counted.begin(), counted.end(), counted_comp);
+		SortCounts counts = counter.counts();
+
+		It out = first;
+		for (Counted<T>& c : counted) *out++ = std::move(c.value());
+		return counts;
+	}
+
+	template<typename It, typename Sort>
+		requires std::random_access_iterator<It>
+	SortCounts CountSort(It first, It last, Sort sort) {
+		return CountSort(first, last, std::less<typename std::iterator_traits<It>::value_type>(), std::move(sort));
+	}
+}
@@ -39,5 +39,50 @@ namespace MayanSort {
 	#define _SortTplD template<typename It> requires std::sortable<It>
 	#define _CompD typedef typename std::less<ItValue<It>> Compare
 
+	// Overloads taking an allocator for the scratch memory (see mayanmem.hpp).
+	#define _SortTplA template<typename It, typename Comp, typename Alloc> \
+		requires std::sortable<It, Comp> && MayanSort::ScratchAllocator<Alloc>
+
+	// Runs the call and returns when the scratch arena is enabled (see mayanmem.hpp). The call
+	// passes _ArenaAlloc as the allocator of the sort.
+	#define _ArenaAlloc MayanSort::_mem::arena_allocator<ItValue<It>>()
+	#define _ArenaExit(...) if (MayanSort::ScratchArenaEnabled()) { \
+		MayanSort::_mem::arena_scope _arena_scope; \
+		__VA_ARGS__; \
+		return; \
+	}
+
+	// Returns from a wrapper if [first, last) is already sorted by comp (see mayansimd.hpp).
+	#define _SortedExit if (MayanSort::_simd::is_sorted(first, last, comp)) return
+
+	// Overloads taking an execution policy (see mayanpar.hpp) as first argument.
+	#define _SortTplP template<typename Policy, typename It, typename Comp> \
+		requires MayanSort::execution::is_execution_policy_v<Policy> && std::sortable<It, Comp>
+	#define _SortTplPD template<typename Policy, typename It> \
+		requires MayanSort::execution::is_execution_policy_v<Policy> && std::sortable<It>
+
+	// Declares Name(policy, first, last, comp) and Name(policy, first, last) for a wrapper.
+	// A sequenced policy calls the wrapper, a parallel one sorts chunks with it and merges them.
+	#define _PolicyWrap(Name) \
+	_SortTplP _SortHead Name(Policy&& policy, It first, It last, Comp comp) { \
+		_parallel::policy_sort(policy, first, last, comp, \
+			[](It f, It l, Comp c) { Name<It, Comp>(f, l, c); }); \
+	} \
+	_SortTplPD _SortHead Name(Policy&& policy, It first, It last) { \
+		_CompD; \
+		Name<Policy, It, Compare>(std::forward<Policy>(policy), first, last, Compare()); \
+	}
+
+	// Same, for a wrapper that has a native parallel version ParallelName(first, last, comp).
+	#define _PolicyWrapNative(Name, ParallelName) \
+	_SortTplP _SortHead Name(Policy&&, It first, It last, Comp comp) { \
+		if constexpr (MayanSort::execution::is_parallel_policy_v<Policy>) ParallelName<It, Comp>(first, last, comp); \
+		else Name<It, Comp>(first, last, comp); \
+	} \
+	_SortTplPD _SortHead Name(Policy&& policy, It first, It last) { \
+		_CompD; \
+		Name<Policy, It, Compare>(std::forward<Policy>(policy), first, last, Compare()); \
+	}
+
 
 }
\ No newline at end of file
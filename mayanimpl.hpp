@@ -25,30 +25,46 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <vector>
 #include "mayandef.hpp"
+#include "mayanmem.hpp"
+#include "mayansimd.hpp"
 
 
 namespace MayanSort {
 	namespace _impl {
-        	template<typename T, typename Size>
-	        struct tmp_buffer{
-	            	T* memory;
-	            	Size size;
-	            	explicit tmp_buffer(Size size){
-			        memory = new T[size];
-		        }
-	            	~tmp_buffer(){
-	                	delete [] memory;
+		// Uninitialized room for size elements, given back when the buffer is destroyed, as
+		// are the first `constructed' elements, which the user builds in place.
+		template<typename T, typename Size>
+		struct tmp_buffer {
+			T* memory;
+			Size size;
+			Size constructed;
+
+			explicit tmp_buffer(Size size) :
+				memory(std::allocator<T>().allocate(size)), size(size), constructed(0) {}
+
+			tmp_buffer(const tmp_buffer&) = delete;
+			tmp_buffer& operator=(const tmp_buffer&) = delete;
+
+			~tmp_buffer() {
+				clear();
+				std::allocator<T>().deallocate(memory, size);
 			}
-		}
+
+			void clear() {
+				std::destroy_n(memory, constructed);
+				constructed = 0;
+			}
+		};
 
 		// Dual-Pivot Quicksort
 		namespace _dualsort {
 			template<typename T, typename Size, typename RandomAccessIterator, typename Compare>
 			requires std::sortable<RandomAccessIterator, Compare>
 			Size _dual_partition(RandomAccessIterator arr, Size low, Size high, Size* lp, Compare comp) {
-				if (arr[low] > arr[high]) std::swap(arr[low], arr[high]);
+				if (comp(arr[high], arr[low])) std::swap(arr[low], arr[high]);
 
 				// p is the left pivot, and q is the right pivot.
 				Size j = low + 1, g = high - 1, k = low + 1;
@@ -64,7 +80,7 @@ namespace MayanSort {
 					// if elements are greater than or equal
 					// to the right pivot
 					else if (comp(q, arr[k])) {
-						while (arr[g] > q && k < g) g--;
+						while (comp(q, arr[g]) && k < g) g--;
 						std::swap(arr[k], arr[g]);
 						g--;
 						if (comp(arr[k], p)) {
@@ -88,17 +104,61 @@ namespace MayanSort {
 				return g;
 			}
 
+			// Puts the second and fourth of five evenly spaced elements of [low, high] at low and
+			// high, so that the pivots split the range in about three thirds whatever its order.
+			template<typename Size, typename RandomAccessIterator, typename Compare>
+			requires std::sortable<RandomAccessIterator, Compare>
+			void _dual_pivots(RandomAccessIterator arr, Size low, Size high, Compare comp) {
+				Size seventh = (high - low + 1) / 7;
+				if (seventh == 0) return;
+				Size mid = low + (high - low) / 2;
+				Size e[5] = { mid - 2 * seventh, mid - seventh, mid, mid + seventh, mid + 2 * seventh };
+				for (int i = 1; i < 5; ++i) {
+					for (int j = i; j > 0 && comp(arr[e[j]], arr[e[j - 1]]); --j)
+						std::iter_swap(arr + e[j], arr + e[j - 1]);
+				}
+				std::iter_swap(arr + low, arr + e[1]);
+				std::iter_swap(arr + high, arr + e[3]);
+			}
+
 			template<typename T, typename Size, typename RandomAccessIterator, typename Compare>
 			requires std::sortable<RandomAccessIterator, Compare>
 			void _dual_sort(RandomAccessIterator arr, Size low, Size high, Compare comp)
 			{
-				if (low < high) {
+				// The two smaller parts are sorted by recursion and the largest by the loop, so
+				// the stack stays logarithmic.
+				while (low < high) {
+					_dual_pivots(arr, low, high, comp);
 					// lp means left pivot, and rp means right pivot.
 					Size lp, rp;
 					rp = _dual_partition<T>(arr, low, high, &lp, comp);
-					_dual_sort<T>(arr, low, lp - 1, comp);
-					_dual_sort<T>(arr, lp + 1, rp - 1, comp);
-					_dual_sort<T>(arr, rp + 1, high, comp);
+
+					// The middle part holds the elements between the pivots. When it is most of
+					// the range, the ones equal to a pivot are moved out of it, since it holds
+					// nothing else when there are few distinct keys; with equal pivots it is done.
+					Size ml = lp + 1, mh = rp - 1;
+					if (!comp(arr[lp], arr[rp])) {
+						ml = rp;
+						mh = rp - 1;
+					}
+					else if (2 * (mh - ml + 1) > high - low + 1) {
+						for (Size k = ml; k <= mh;) {
+							if (!comp(arr[lp], arr[k])) std::iter_swap(arr + k++, arr + ml++);
+							else if (!comp(arr[k], arr[rp])) std::iter_swap(arr + k, arr + mh--);
+							else ++k;
+						}
+					}
+
+					Size parts[3][2] = { { low, lp - 1 }, { ml, mh }, { rp + 1, high } };
+					int largest = 0;
+					for (int i = 1; i < 3; ++i) {
+						if (parts[i][1] - parts[i][0] > parts[largest][1] - parts[largest][0]) largest = i;
+					}
+					for (int i = 0; i < 3; ++i) {
+						if (i != largest) _dual_sort<T>(arr, parts[i][0], parts[i][1], comp);
+					}
+					low = parts[largest][0];
+					high = parts[largest][1];
 				}
 			}
 
@@ -106,7 +166,7 @@ namespace MayanSort {
 			requires std::sortable<RandomAccessIterator, Compare>
 			void dqsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
 				_dual_sort<MayanSort::ItValue<RandomAccessIterator>>
-					(first, (MayanSort::ItSize<RandomAccessIterator>)0, std::distance(first, last), comp);
+					(first, (MayanSort::ItSize<RandomAccessIterator>)0, std::distance(first, last) - 1, comp);
 			}
 		}
 
@@ -172,23 +232,26 @@ namespace MayanSort {
 			requires std::sortable<RandomAccessIterator, Comp>
 			void _bitonic_cmp(RandomAccessIterator a, Size i, Size j, bool dir, Comp comp)
 			{
-				if (!dir == comp(a[j], a[i])) std::swap(a[i], a[j]);
+				if (dir == comp(a[j], a[i])) std::iter_swap(a + i, a + j);
 			}
 
 			/*It recursively sorts a bitonic sequence in ascending order,
 			  if dir = 1, and in descending order otherwise (means dir=0).
 			  The sequence to be sorted starts at index position low,
-			  the parameter cnt is the number of elements to be sorted.*/
+			  the parameter cnt is the number of elements to be sorted.
+			  For any cnt, the first cnt - k elements are compared with the
+			  ones k further, k being the largest power of two below cnt.*/
 			template<typename RandomAccessIterator, typename Size, typename Comp>
 			requires std::sortable<RandomAccessIterator, Comp>
 			void _bitonic_merge(RandomAccessIterator a, Size low, Size cnt, bool dir, Comp comp)
 			{
 				if (cnt > 1)
 				{
-					Size k = cnt / 2;
-					for (Size i = low; i < low + k; i++) _bitonic_cmp(a, i, i + k, dir, comp);
+					Size k = 1;
+					while (k < cnt - k) k *= 2;
+					for (Size i = low; i < low + cnt - k; i++) _bitonic_cmp(a, i, i + k, dir, comp);
 					_bitonic_merge(a, low, k, dir, comp);
-					_bitonic_merge(a, low + k, k, dir, comp);
+					_bitonic_merge(a, low + k, cnt - k, dir, comp);
 				}
 			}
 
@@ -203,14 +266,13 @@ namespace MayanSort {
 				{
 					Size k = cnt / 2;
 
-					// sort in ascending order since dir here is 1
-					_bitonic_sort(a, low, k, 1, comp);
+					// sort the first half in the other order
+					_inner_bitonic_sort(a, low, k, !dir, comp);
 
-					// sort in descending order since dir here is 0
-					_bitonic_sort(a, low + k, k, 0, comp);
+					// sort the second half in this order
+					_inner_bitonic_sort(a, low + k, cnt - k, dir, comp);
 
-					// Will merge whole sequence in ascending order
-					// since dir=1.
+					// Will merge whole sequence in the order dir.
 					_bitonic_merge(a, low, cnt, dir, comp);
 				}
 			}
@@ -221,7 +283,7 @@ namespace MayanSort {
 				_inner_bitonic_sort(
 					first, 
 					(MayanSort::ItSize<RandomAccessIterator>)0, std::distance(first, last),
-					false, comp);
+					true, comp);
 			}
 		}
 
@@ -250,7 +312,7 @@ namespace MayanSort {
 			template<typename RandomAccessIterator, typename Size, typename Comp>
 			requires std::sortable<RandomAccessIterator, Comp>
 			void _ternary_heapsort(RandomAccessIterator arr, Size n, Comp comp) {
-				for (Size i = n / 3 - 1; i >= 0; i--)
+				for (Size i = (n - 2) / 3; i >= 0; i--)
 					_ternary_heapify(arr, n, i, comp);
 
 				for (Size i = n - 1; i >= 0; i--) {
@@ -401,15 +463,18 @@ namespace MayanSort {
 				}
 			}
 
-			template<typename RandomAccessIterator, class Comp>
+			// The flags are taken from alloc (see mayanmem.hpp).
+			template<typename RandomAccessIterator, class Comp, class Alloc = std::allocator<unsigned char>>
 			requires std::sortable<RandomAccessIterator, Comp>
-			void weakheap_sort(RandomAccessIterator beg, RandomAccessIterator end, Comp compare)
+			void weakheap_sort(RandomAccessIterator beg, RandomAccessIterator end, Comp compare,
+				const Alloc& alloc = Alloc())
 			{
 				if (end - beg > 1)
 				{
 					size_t n = (size_t)(end - beg);
-					unsigned char* flags = new unsigned char[(n + 7) / 8];
-					for (size_t i = 0; i < n / 8; ++i)
+					_mem::buffer<unsigned char, Alloc> flag_buffer((n + 7) / 8, alloc);
+					unsigned char* flags = flag_buffer.data();
+					for (size_t i = 0; i < (n + 7) / 8; ++i)
 						flags[i] = 0;
 					for (size_t i = n - 1; i > 0; --i)
 					{
@@ -431,7 +496,6 @@ namespace MayanSort {
 						}
 					}
 					std::swap(*beg, *(beg + 1));
-					delete[] flags;
 				}
 			}
 		}
@@ -475,7 +539,7 @@ namespace MayanSort {
 			template<typename RandomAccessIterator, typename Compare>
 			requires std::sortable<RandomAccessIterator, Compare>
 			void stooge_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
-				_inner_stoogesort(first, (MayanSort::ItSize<It>)0, std::distance(first, last) - 1, comp);
+				_inner_stoogesort(first, (MayanSort::ItSize<RandomAccessIterator>)0, std::distance(first, last) - 1, comp);
 			}
 
 			// Slow Sort
@@ -510,7 +574,7 @@ namespace MayanSort {
 			template<typename RandomAccessIterator, typename Compare>
 			requires std::sortable<RandomAccessIterator, Compare>
 			void slow_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
-				_inner_slow_sort(first, (MayanSort::ItSize<It>)0, std::distance(first, last) - 1, comp);
+				_inner_slow_sort(first, (MayanSort::ItSize<RandomAccessIterator>)0, std::distance(first, last) - 1, comp);
 			}
 		}
 
@@ -528,49 +592,72 @@ namespace MayanSort {
 					// Compare first so we can avoid 2 moves for
 					// an element already positioned correctly.
 					if (compare(*sift, *sift_1)) {
-						T tmp = *sift;
+						T tmp = std::move(*sift);
 						do {
-							*sift-- = *sift_1;
+							*sift-- = std::move(*sift_1);
 						} while (sift != first && compare(tmp, *--sift_1));
-						*sift = tmp;
+						*sift = std::move(tmp);
 					}
 				}
 			}
 
-			template<typename InputIter, typename OutputIter>
-			OutputIter _weave_merge(InputIter first, InputIter mid, InputIter last, OutputIter dest) {
+			// Moves the elements of [first, mid) and [mid, last) alternately into the buffer,
+			// constructing them there, and returns the end of the weave.
+			template<typename InputIter, typename T, typename Size>
+			T* _weave_merge(InputIter first, InputIter mid, InputIter last, _impl::tmp_buffer<T, Size>& buf) {
 				InputIter a = first, b = mid;
-				OutputIter c = dest;
 				bool flag = false;
 
 				while (a < mid && b < last) {
-					if (flag) *c++ = *a++;
-					else *c++ = *b++;
+					if (flag) std::construct_at(buf.memory + buf.constructed, std::move(*a++));
+					else std::construct_at(buf.memory + buf.constructed, std::move(*b++));
+					++buf.constructed;
 					flag = !flag;
 				}
-				if (a < mid) c = std::copy(a, mid, c);
-				if (b < last) c = std::copy(b, last, c);
-				return c;
-			}
-                        template<typename BidIter, typename T, typename Compare>
-                        void _merge_with_buffer(BidIter first, BidIter mid, BidIter last, T *buffer, Compare compare){
-				T* end = _weave_merge(first, mid, last, buffer);
-				_insertion_sort(buffer, end, compare);
-				std::copy(buffer, end, first);
+				for (; a < mid; ++buf.constructed) std::construct_at(buf.memory + buf.constructed, std::move(*a++));
+				for (; b < last; ++buf.constructed) std::construct_at(buf.memory + buf.constructed, std::move(*b++));
+				return buf.memory + buf.constructed;
+			}
+                        template<typename BidIter, typename T, typename Size, typename Compare>
+                        void _merge_with_buffer(BidIter first, BidIter mid, BidIter last, _impl::tmp_buffer<T, Size>& buf, Compare compare){
+				// For arithmetic keys the weave and insertion sort give a plain merge, which is
+				// done with vectors (see mayansimd.hpp).
+				if constexpr (_simd::merge_usable<BidIter, BidIter, T*, Compare>) {
+					BidIter a = first, b = mid;
+					T* c = buf.memory;
+					std::size_t taken1, taken2;
+					while (_simd::merge<false>(a, mid, b, last, c, compare, taken1, taken2)) {
+						a += taken1;
+						b += taken2;
+						c += taken1 + taken2;
+					}
+					c = std::merge(a, mid, b, last, c, compare);
+					std::copy(buf.memory, c, first);
+					return;
+				}
+				T* end = _weave_merge(first, mid, last, buf);
+				_insertion_sort(buf.memory, end, compare);
+				std::move(buf.memory, end, first);
+				buf.clear();
 			}
-				
 
 			template<typename BidIter, typename T, typename Size, typename Compare>
-			void wsort(BidIter first, BidIter last, Compare compare) {
+			void _wsort(BidIter first, BidIter last, Compare compare, _impl::tmp_buffer<T, Size>& buf) {
 				Size dis = std::distance(first, last);
 				if (dis < 2) return;
 				BidIter mid = std::next(first, dis / 2);
-				wsort<BidIter, T, Size, Compare>(first, mid, compare);
-				wsort<BidIter, T, Size, Compare>(mid, last, compare);
+				_wsort(first, mid, compare, buf);
+				_wsort(mid, last, compare, buf);
+			    _merge_with_buffer(first, mid, last, buf, compare);
+			}
 
-				_impl::_tmp_buffer<T, Size> buf_object(dis);
-			    _merge_with_buffer(first, mid, last, buf_object.memory, compare);
-				delete buf_object;
+			// One buffer, as large as the range, serves every merge.
+			template<typename BidIter, typename T, typename Size, typename Compare>
+			void wsort(BidIter first, BidIter last, Compare compare) {
+				Size dis = std::distance(first, last);
+				if (dis < 2) return;
+				_impl::tmp_buffer<T, Size> buf_object(dis);
+				_wsort(first, last, compare, buf_object);
 			}
 
 		}
@@ -633,18 +720,18 @@ namespace MayanSort {
 		template<typename RandomAccessIterator, typename Compare>
 		void circle_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
 			typedef typename MayanSort::ItValue<RandomAccessIterator> T;
-			_inner_circleSort<t>(first, std::distance(first, last), comp);
+			_inner_circleSort<T>(first, std::distance(first, last), comp);
 		}
 
 		template<typename RandomAccessIterator, typename Distance, typename Compare>
 		void _inner_gnomeSort(RandomAccessIterator a, Distance n, Compare comp) {
 			Distance i = 0;
 			while (i < n) {
-				if (i == 0 || comp(a[i - 1], a[i])) {
+				if (i == 0 || !comp(a[i], a[i - 1])) {
 					i++;
 				}
 				else {
-					swap(a[i], a[i - 1]);
+					std::iter_swap(a + i, a + (i - 1));
 					i--;
 				}
 			}
@@ -686,9 +773,10 @@ namespace MayanSort {
 			_inner_shellSort<T>(first, std::distance(first, last), comp);
 		}
 
-		template<typename T, typename RandomAccessIterator, typename Size, typename Comp>
-		void _patience_sort(RandomAccessIterator arr, Size n, Comp comp) {
-			std::vector<std::vector<T>> piles;
+		template<typename T, typename RandomAccessIterator, typename Size, typename Comp, typename Alloc>
+		void _patience_sort(RandomAccessIterator arr, Size n, Comp comp, const Alloc& alloc) {
+			typedef std::vector<T, _mem::rebind_t<Alloc, T>> Pile;
+			std::vector<Pile, _mem::rebind_t<Alloc, Pile>> piles(alloc);
 			for (Size i = 0; i < n; i++) {
 				T x = arr[i];
 				bool found = false;
@@ -700,7 +788,7 @@ namespace MayanSort {
 					}
 				}
 				if (!found) {
-					piles.emplace_back();
+					piles.emplace_back(alloc);
 					piles.back().push_back(x);
 				}
 			}
@@ -720,10 +808,13 @@ namespace MayanSort {
 			}
 		}
 
-		template<typename RandomAccessIterator, typename Compare>
-		void patience_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+		// The piles are taken from alloc (see mayanmem.hpp).
+		template<typename RandomAccessIterator, typename Compare,
+			typename Alloc = std::allocator<MayanSort::ItValue<RandomAccessIterator>>>
+		void patience_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+			const Alloc& alloc = Alloc()){
 			typedef typename MayanSort::ItValue<RandomAccessIterator> T;
-			_patience_sort<T>(first, std::distance(first, last), comp);
+			_patience_sort<T>(first, std::distance(first, last), comp, alloc);
 		}
 
 		// A function to sort the algorithm using Odd Even sort
@@ -855,45 +946,35 @@ namespace MayanSort {
 			}
 		}
 
+		// The sorted part grows from the middle by a pair at a time: the two elements around it
+		// are ordered, then the smaller one is inserted to the right and the larger one to the left.
 		template<typename sort_element_t, typename iter_t, typename compare_func_t>
 		void _double_insert_sort(iter_t beg, iter_t end, compare_func_t comp)
 		{
-			if (end - beg > 1)
+			iter_t lo = beg + (end - beg) / 2, hi = lo + (end - beg) % 2;
+			while (lo != beg)
 			{
-				for (iter_t i = beg + 1, *j = end - 1; ; )
-				{
-					sort_element_t val = *i;
-					iter_t t = i;
-					for (; t > beg && comp(val, t[-1]); --t)
-					{
-						*t = t[-1];
-					}
-					*t = val;
+				iter_t a = lo - 1, b = hi;
+				if (comp(*b, *a)) std::iter_swap(a, b);
 
-					if (++i > j)
-					{
-						if (comp(*i, *j))
-							++j;
-						else
-							break;
-					}
-
-					val = j[-1];
-					t = j;
-					for (; t < end && comp(*t, val); ++t)
-					{
-						t[-1] = *t;
-					}
-					t[-1] = val;
+				sort_element_t val = std::move(*a);
+				iter_t t = a;
+				for (; t + 1 < hi && comp(t[1], val); ++t)
+				{
+					*t = std::move(t[1]);
+				}
+				*t = std::move(val);
 
-					if (i > --j)
-					{
-						if (comp(*j, j[-1]))
-							--i;
-						else
-							break;
-					}
+				val = std::move(*b);
+				t = b;
+				for (; t > a && comp(val, t[-1]); --t)
+				{
+					*t = std::move(t[-1]);
 				}
+				*t = std::move(val);
+
+				lo = a;
+				hi = b + 1;
 			}
 		}
 
@@ -0,0 +1,422 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// mayanmem.hpp: Scratch memory of the sorts.
+// The sorts that need a buffer take an optional allocator, which they rebind to the types they
+// store. Any standard allocator works: a std::pmr::polymorphic_allocator over a
+// std::pmr::monotonic_buffer_resource that is released between sorts, for example, lets a loop
+// run any number of sorts without touching the global heap.
+// SetScratchArena(true) does the same for the overloads without an allocator: they then take
+// their memory from a grow-only arena of the calling thread, which can be backed by
+// transparent huge pages and reports how often it was reused.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "mayansimd.hpp"
+
+namespace MayanSort {
+
+	// Allocators accepted for the scratch memory of a sort.
+	template<typename A>
+	concept ScratchAllocator = requires(A& a, std::size_t n) {
+		typename A::value_type;
+		a.deallocate(a.allocate(n), n);
+	};
+
+	// Statistics of the scratch arena of a thread, see CurrentScratchArenaStats().
+	struct ScratchArenaStats {
+		std::size_t reserved_bytes = 0;     // Held by the arena.
+		std::size_t peak_bytes = 0;         // Most bytes in use at once.
+		std::size_t system_allocations = 0; // Blocks obtained from the system.
+		std::size_t sorts = 0;              // Sorts that used the arena.
+		std::size_t reuse_hits = 0;         // Sorts served without a system allocation.
+	};
+
+	namespace _mem {
+		template<typename Alloc, typename T>
+		using rebind_t = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+		// Storage for elements of type T from an allocator, given back when the buffer is
+		// destroyed. The slots are left uninitialized: prime() constructs the ones a sort is
+		// about to assign to, and only those are destroyed again. reserve() grows the buffer at
+		// least twofold and drops its contents, so that one buffer can serve every merge of a
+		// sort. Trivially copyable types are never constructed, the sorts write them before
+		// reading.
+		template<typename T, typename Alloc = std::allocator<T> >
+		class buffer {
+			typedef rebind_t<Alloc, T> alloc_t;
+			typedef std::allocator_traits<alloc_t> traits;
+			static constexpr bool trivial = std::is_trivially_copyable_v<T>;
+
+			alloc_t alloc_;
+			typename traits::pointer data_;
+			std::size_t size_;
+			std::size_t live_; // Constructed slots, always a prefix.
+
+			void release() {
+				if (size_ == 0)
+					return;
+				for (; live_ > 0; --live_)
+					traits::destroy(alloc_, std::to_address(data_) + live_ - 1);
+				traits::deallocate(alloc_, data_, size_);
+				data_ = nullptr;
+				size_ = 0;
+			}
+
+		public:
+			explicit buffer(const Alloc& alloc = Alloc()) : alloc_(alloc), data_(nullptr), size_(0), live_(0) {}
+
+			explicit buffer(std::size_t n, const Alloc& alloc = Alloc()) : buffer(alloc) {
+				reserve(n);
+			}
+
+			buffer(const buffer&) = delete;
+			buffer& operator=(const buffer&) = delete;
+
+			~buffer() {
+				release();
+			}
+
+			// Makes room for n elements and returns them, uninitialized unless they were
+			// primed before.
+			T* reserve(std::size_t n) {
+				if (n <= size_)
+					return data();
+				n = std::max(n, 2 * size_);
+				release();
+				data_ = traits::allocate(alloc_, n);
+				size_ = n;
+				return data();
+			}
+
+			// Makes room for n elements and makes sure they are all constructed, so that they
+			// can be assigned to. Missing ones are move-constructed from the elements at the
+			// same place in [first, first + n), which get their value back right after, so no
+			// default constructor or copy is needed.
+			template<typename It>
+			T* prime(It first, std::size_t n) {
+				T* p = reserve(n);
+				if constexpr (!trivial) {
+					while (live_ < n) {
+						auto&& src = first[live_];
+						traits::construct(alloc_, p + live_, std::move(src));
+						src = std::move(p[live_++]);
+					}
+				}
+				return p;
+			}
+
+			T* data() const {
+				return size_ ? std::to_address(data_) : nullptr;
+			}
+
+			std::size_t size() const {
+				return size_;
+			}
+
+			alloc_t get_allocator() const {
+				return alloc_;
+			}
+		};
+
+		// Allocator that fails with std::bad_alloc rather than take the bytes held by all its
+		// copies over a budget. The bytes left are kept by the caller.
+		template<typename T>
+		struct capped_allocator {
+			typedef T value_type;
+
+			std::size_t* left;
+
+			explicit capped_allocator(std::size_t* left) : left(left) {}
+
+			template<typename U>
+			capped_allocator(const capped_allocator<U>& other) : left(other.left) {}
+
+			T* allocate(std::size_t n) {
+				if (n > *left / sizeof(T))
+					throw std::bad_alloc();
+				T* p = std::allocator<T>().allocate(n);
+				*left -= n * sizeof(T);
+				return p;
+			}
+
+			void deallocate(T* p, std::size_t n) {
+				std::allocator<T>().deallocate(p, n);
+				*left += n * sizeof(T);
+			}
+
+			template<typename U>
+			bool operator==(const capped_allocator<U>& other) const {
+				return left == other.left;
+			}
+		};
+
+		// Blocks of this size and more can be backed by transparent huge pages.
+		constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+		inline std::atomic<bool>& arena_enabled() {
+			static std::atomic<bool> enabled(false);
+			return enabled;
+		}
+
+		inline std::atomic<bool>& arena_huge_pages() {
+			static std::atomic<bool> enabled(false);
+			return enabled;
+		}
+
+		// Grow-only bump allocator of one thread. The sorts allocate from it inside an
+		// arena_scope, and nothing is given back before the outermost scope ends. What does not
+		// fit in the block goes to overflow blocks, which the end of the outermost scope
+		// replaces with one block as large as all of them: the next sort of the same size is
+		// then served from that block alone.
+		class arena {
+			struct block {
+				std::byte* data;
+				std::size_t size;
+				bool mapped;
+			};
+
+			block current_ = { nullptr, 0, false };
+			std::size_t used_ = 0;
+			std::vector<block> overflow_;
+			std::size_t overflow_used_ = 0;
+			std::size_t in_use_ = 0;
+			std::size_t depth_ = 0;
+			std::size_t scope_allocations_ = 0;
+			ScratchArenaStats stats_;
+
+			static std::size_t align_up(std::size_t n, std::size_t align) {
+				return (n + align - 1) & ~(align - 1);
+			}
+
+			block acquire(std::size_t size) {
+				std::size_t line = _simd::cacheline_size();
+				size = align_up(size, line);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+				if (size >= huge_page_size && arena_huge_pages().load(std::memory_order_relaxed)) {
+					size = align_up(size, huge_page_size);
+					void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+					if (p != MAP_FAILED) {
+						::madvise(p, size, MADV_HUGEPAGE);
+						return count({ static_cast<std::byte*>(p), size, true });
+					}
+				}
+#endif
+				void* p = ::operator new(size, std::align_val_t(line));
+				return count({ static_cast<std::byte*>(p), size, false });
+			}
+
+			block count(block b) {
+				++stats_.system_allocations;
+				++scope_allocations_;
+				stats_.reserved_bytes += b.size;
+				return b;
+			}
+
+			void give_back(block& b) {
+				if (!b.data)
+					return;
+				stats_.reserved_bytes -= b.size;
+#if defined(__linux__)
+				if (b.mapped) {
+					::munmap(b.data, b.size);
+					b = { nullptr, 0, false };
+					return;
+				}
+#endif
+				::operator delete(b.data, std::align_val_t(_simd::cacheline_size()));
+				b = { nullptr, 0, false };
+			}
+
+			// Takes n bytes at align from b, whose first used bytes are taken.
+			static void* take(block& b, std::size_t& used, std::size_t n, std::size_t align) {
+				std::size_t at = align_up(used, align);
+				if (!b.data || at > b.size || b.size - at < n)
+					return nullptr;
+				used = at + n;
+				return b.data + at;
+			}
+
+		public:
+			struct mark {
+				std::size_t used, overflow, overflow_used, in_use;
+			};
+
+			arena() = default;
+			arena(const arena&) = delete;
+			arena& operator=(const arena&) = delete;
+
+			~arena() {
+				release();
+			}
+
+			void* allocate(std::size_t n, std::size_t align) {
+				align = std::max(align, _simd::cacheline_size());
+				n = align_up(std::max<std::size_t>(n, 1), align);
+				void* p = take(current_, used_, n, align);
+				if (!p && !overflow_.empty())
+					p = take(overflow_.back(), overflow_used_, n, align);
+				if (!p) {
+					std::size_t last = overflow_.empty() ? current_.size : overflow_.back().size;
+					overflow_.push_back(acquire(std::max(n + align, 2 * last)));
+					overflow_used_ = 0;
+					p = take(overflow_.back(), overflow_used_, n, align);
+				}
+				in_use_ += n;
+				stats_.peak_bytes = std::max(stats_.peak_bytes, in_use_);
+				return p;
+			}
+
+			mark enter() {
+				if (depth_++ == 0)
+					scope_allocations_ = 0;
+				return { used_, overflow_.size(), overflow_used_, in_use_ };
+			}
+
+			void leave(const mark& m) {
+				if (overflow_.size() == m.overflow) {
+					used_ = m.used;
+					overflow_used_ = m.overflow_used;
+					in_use_ = m.in_use;
+				}
+				if (--depth_ != 0)
+					return;
+
+				++stats_.sorts;
+				if (!overflow_.empty()) {
+					std::size_t total = current_.size;
+					for (block& b : overflow_) {
+						total += b.size;
+						give_back(b);
+					}
+					overflow_.clear();
+					give_back(current_);
+					current_ = acquire(total);
+				}
+				if (scope_allocations_ == 0)
+					++stats_.reuse_hits;
+				used_ = overflow_used_ = in_use_ = 0;
+			}
+
+			// Frees the blocks and clears the statistics, outside of any scope.
+			void release() {
+				if (depth_ != 0)
+					return;
+				for (block& b : overflow_)
+					give_back(b);
+				overflow_.clear();
+				give_back(current_);
+				stats_ = ScratchArenaStats();
+			}
+
+			const ScratchArenaStats& stats() const {
+				return stats_;
+			}
+		};
+
+		inline arena& thread_arena() {
+			thread_local arena instance;
+			return instance;
+		}
+
+		// Opens a scope of the arena of this thread for a sort.
+		class arena_scope {
+			arena& arena_;
+			arena::mark mark_;
+
+		public:
+			arena_scope() : arena_(thread_arena()), mark_(arena_.enter()) {}
+
+			arena_scope(const arena_scope&) = delete;
+			arena_scope& operator=(const arena_scope&) = delete;
+
+			~arena_scope() {
+				arena_.leave(mark_);
+			}
+		};
+
+		// Allocator of the arena of the calling thread, for use inside an arena_scope.
+		// Deallocation is a no-op, the memory comes back when the scope ends.
+		template<typename T>
+		struct arena_allocator {
+			typedef T value_type;
+
+			arena_allocator() = default;
+
+			template<typename U>
+			arena_allocator(const arena_allocator<U>&) {}
+
+			T* allocate(std::size_t n) {
+				if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+					throw std::bad_array_new_length();
+				return static_cast<T*>(thread_arena().allocate(n * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(T*, std::size_t) {}
+
+			template<typename U>
+			bool operator==(const arena_allocator<U>&) const {
+				return true;
+			}
+		};
+	}
+
+	// Makes the sorts that need scratch memory take it from a grow-only arena of the calling
+	// thread when they are not given an allocator. Off by default.
+	inline void SetScratchArena(bool enabled) {
+		_mem::arena_enabled().store(enabled, std::memory_order_relaxed);
+	}
+
+	inline bool ScratchArenaEnabled() {
+		return _mem::arena_enabled().load(std::memory_order_relaxed);
+	}
+
+	// Backs the arena blocks of 2 MiB and more with transparent huge pages (Linux only).
+	inline void SetScratchArenaHugePages(bool enabled) {
+		_mem::arena_huge_pages().store(enabled, std::memory_order_relaxed);
+	}
+
+	// Statistics of the arena of the calling thread. Once a workload is warm, every sort
+	// should count as a reuse hit.
+	inline ScratchArenaStats CurrentScratchArenaStats() {
+		return _mem::thread_arena().stats();
+	}
+
+	// Frees the arena of the calling thread and clears its statistics.
+	inline void ReleaseScratchArena() {
+		_mem::thread_arena().release();
+	}
+}
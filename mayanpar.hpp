@@ -0,0 +1,668 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// mayanpar.hpp: Parallel execution support: shared work-stealing scheduler, execution
+// policies and the generic parallel path (chunked sort followed by a multiway merge).
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
+namespace MayanSort {
+
+	// Interface for running the parallel sorts on threads owned by the caller. post() must
+	// run job exactly once, on any thread, at any later time. The thread that starts a
+	// parallel sort works on it as well, so a sort also completes when jobs run late.
+	class Executor {
+	public:
+		virtual ~Executor() = default;
+
+		virtual void post(std::function<void()> job) = 0;
+
+		// Number of threads the executor runs jobs on.
+		virtual unsigned concurrency() const = 0;
+	};
+
+	namespace _parallel {
+
+		// Number of hardware threads.
+		inline unsigned hardware_threads() {
+			unsigned n = std::thread::hardware_concurrency();
+			return n == 0 ? 1 : n;
+		}
+
+		// A set of tasks that can be waited on together.
+		// The first exception thrown by a task is rethrown from TaskPool::wait.
+		class TaskGroup {
+			friend class Scheduler;
+			friend class TaskPool;
+
+			std::atomic<std::size_t> pending_{ 0 };
+			std::mutex error_lock_;
+			std::exception_ptr error_;
+
+			void fail(std::exception_ptr e) {
+				std::lock_guard<std::mutex> guard(error_lock_);
+				if (!error_) error_ = e;
+			}
+		};
+
+		struct Task {
+			TaskGroup* group;
+			std::function<void()> run;
+		};
+
+		// Chase-Lev work-stealing deque, after "Correct and Efficient Work-Stealing for Weak
+		// Memory Models" (Le et al., 2013). The owner pushes and pops at the bottom, the other
+		// threads steal at the top. Replaced arrays are kept until the deque is destroyed, as
+		// a thief may still read from them.
+		class WorkDeque {
+			struct Array {
+				std::int64_t mask;
+				std::unique_ptr<std::atomic<Task*>[]> slots;
+
+				explicit Array(std::int64_t capacity) : mask(capacity - 1), slots(new std::atomic<Task*>[capacity]) {}
+
+				Task* get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_acquire); }
+				void put(std::int64_t i, Task* t) { slots[i & mask].store(t, std::memory_order_release); }
+			};
+
+			alignas(64) std::atomic<std::int64_t> top_{ 0 };
+			alignas(64) std::atomic<std::int64_t> bottom_{ 0 };
+			std::atomic<Array*> array_;
+			std::vector<std::unique_ptr<Array> > arrays_;
+
+		public:
+			WorkDeque() {
+				arrays_.emplace_back(new Array(256));
+				array_.store(arrays_.back().get(), std::memory_order_relaxed);
+			}
+
+			WorkDeque(const WorkDeque&) = delete;
+			WorkDeque& operator=(const WorkDeque&) = delete;
+
+			// Owner only.
+			void push(Task* task) {
+				std::int64_t b = bottom_.load(std::memory_order_relaxed);
+				std::int64_t t = top_.load(std::memory_order_acquire);
+				Array* a = array_.load(std::memory_order_relaxed);
+				if (b - t > a->mask) {
+					Array* bigger = new Array(2 * (a->mask + 1));
+					for (std::int64_t i = t; i < b; ++i) bigger->put(i, a->get(i));
+					arrays_.emplace_back(bigger);
+					array_.store(bigger, std::memory_order_release);
+					a = bigger;
+				}
+				a->put(b, task);
+				std::atomic_thread_fence(std::memory_order_release);
+				bottom_.store(b + 1, std::memory_order_relaxed);
+			}
+
+			// Owner only.
+			Task* pop() {
+				std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+				Array* a = array_.load(std::memory_order_relaxed);
+				bottom_.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				std::int64_t t = top_.load(std::memory_order_relaxed);
+
+				Task* task = nullptr;
+				if (t <= b) {
+					task = a->get(b);
+					if (t == b) {
+						// Last task, race against the thieves.
+						if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+							task = nullptr;
+						}
+						bottom_.store(b + 1, std::memory_order_relaxed);
+					}
+				}
+				else {
+					bottom_.store(b + 1, std::memory_order_relaxed);
+				}
+				return task;
+			}
+
+			Task* steal() {
+				std::int64_t t = top_.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				std::int64_t b = bottom_.load(std::memory_order_acquire);
+				if (t >= b) return nullptr;
+
+				Task* task = array_.load(std::memory_order_acquire)->get(t);
+				if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					return nullptr;
+				}
+				return task;
+			}
+		};
+
+		// Library-owned work-stealing scheduler shared by all parallel sorts.
+		// Every worker owns a WorkDeque, tasks spawned by other threads go to a shared queue.
+		// Idle workers spin for a while, then sleep until new tasks are spawned.
+		// With an Executor there are no workers, every spawned task posts a job running one
+		// queued task instead.
+		class Scheduler : public std::enable_shared_from_this<Scheduler> {
+			std::vector<std::unique_ptr<WorkDeque> > deques_;
+			std::vector<std::thread> workers_;
+			Executor* executor_;
+			unsigned concurrency_;
+
+			std::mutex shared_lock_;
+			std::deque<Task*> shared_;
+			std::atomic<std::size_t> shared_size_{ 0 };
+
+			std::atomic<bool> stop_{ false };
+			std::atomic<std::uint64_t> epoch_{ 0 };
+			std::atomic<unsigned> sleepers_{ 0 };
+			std::mutex sleep_lock_;
+			std::condition_variable wake_;
+
+			// Scheduler and 1-based worker index of the calling thread, 0 if not a worker.
+			static std::pair<Scheduler*, unsigned>& current() {
+				static thread_local std::pair<Scheduler*, unsigned> cur{ nullptr, 0 };
+				return cur;
+			}
+
+			unsigned self() const {
+				return current().first == this ? current().second : 0;
+			}
+
+			Task* take_shared() {
+				if (shared_size_.load(std::memory_order_acquire) == 0) return nullptr;
+				std::lock_guard<std::mutex> guard(shared_lock_);
+				if (shared_.empty()) return nullptr;
+				Task* task = shared_.front();
+				shared_.pop_front();
+				shared_size_.fetch_sub(1, std::memory_order_relaxed);
+				return task;
+			}
+
+			Task* steal(unsigned id) {
+				std::size_t n = deques_.size();
+				for (std::size_t i = 0; i < n; ++i) {
+					std::size_t victim = (id + i) % n;
+					if (victim + 1 == id) continue;
+					if (Task* task = deques_[victim]->steal()) return task;
+				}
+				return nullptr;
+			}
+
+			static void execute(Task* task) {
+				TaskGroup* group = task->group;
+				std::function<void()> run = std::move(task->run);
+				delete task;
+				try {
+					run();
+				}
+				catch (...) {
+					group->fail(std::current_exception());
+				}
+				run = nullptr;
+				group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+			}
+
+			void notify() {
+				epoch_.fetch_add(1, std::memory_order_seq_cst);
+				if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+					std::lock_guard<std::mutex> guard(sleep_lock_);
+					wake_.notify_one();
+				}
+			}
+
+			void worker(unsigned id) {
+				current() = std::make_pair(this, id);
+				unsigned idle = 0;
+				while (!stop_.load(std::memory_order_acquire)) {
+					std::uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+					if (run_one(id)) {
+						// The task dropped the last reference: the scheduler is gone.
+						if (current().first != this) return;
+						idle = 0;
+						continue;
+					}
+					if (++idle < 64) {
+						std::this_thread::yield();
+						continue;
+					}
+
+					std::unique_lock<std::mutex> lock(sleep_lock_);
+					sleepers_.fetch_add(1, std::memory_order_seq_cst);
+					wake_.wait(lock, [&]() {
+						return stop_.load(std::memory_order_acquire) || epoch_.load(std::memory_order_seq_cst) != epoch;
+					});
+					sleepers_.fetch_sub(1, std::memory_order_relaxed);
+					idle = 0;
+				}
+			}
+
+		public:
+			// Starts `threads` workers, or none if executor is not null.
+			Scheduler(unsigned threads, Executor* executor) : executor_(executor) {
+				if (executor_) {
+					concurrency_ = executor_->concurrency() + 1;
+					return;
+				}
+				concurrency_ = threads;
+				for (unsigned i = 0; i < threads; ++i) deques_.emplace_back(new WorkDeque());
+				for (unsigned i = 0; i < threads; ++i) workers_.emplace_back(&Scheduler::worker, this, i + 1);
+			}
+
+			~Scheduler() {
+				{
+					std::lock_guard<std::mutex> guard(sleep_lock_);
+					stop_.store(true, std::memory_order_release);
+				}
+				wake_.notify_all();
+
+				// The last reference can be dropped by a task running on one of the workers,
+				// which cannot join itself: it is detached and leaves its loop instead.
+				for (std::thread& t : workers_) {
+					if (t.get_id() == std::this_thread::get_id()) {
+						current() = std::make_pair(nullptr, 0u);
+						t.detach();
+					}
+					else {
+						t.join();
+					}
+				}
+			}
+
+			Scheduler(const Scheduler&) = delete;
+			Scheduler& operator=(const Scheduler&) = delete;
+
+			// The scheduler the calling thread works for, if it is a worker.
+			static Scheduler* current_worker() {
+				return current().second != 0 ? current().first : nullptr;
+			}
+
+			unsigned concurrency() const {
+				return concurrency_;
+			}
+
+			template<typename F>
+			void spawn(TaskGroup& group, F&& f) {
+				group.pending_.fetch_add(1, std::memory_order_relaxed);
+				Task* task = new Task{ &group, std::function<void()>(std::forward<F>(f)) };
+
+				unsigned id = self();
+				if (id != 0) {
+					deques_[id - 1]->push(task);
+				}
+				else {
+					std::lock_guard<std::mutex> guard(shared_lock_);
+					shared_.push_back(task);
+					shared_size_.fetch_add(1, std::memory_order_release);
+				}
+
+				if (executor_) {
+					std::shared_ptr<Scheduler> self_ptr = shared_from_this();
+					executor_->post([self_ptr]() { self_ptr->run_one(0); });
+				}
+				else {
+					notify();
+				}
+			}
+
+			// Runs one queued task, preferring the own deque of a worker. Returns false if there
+			// was none.
+			bool run_one(unsigned id) {
+				Task* task = id != 0 ? deques_[id - 1]->pop() : nullptr;
+				if (!task) task = take_shared();
+				if (!task) task = steal(id);
+				if (!task) return false;
+				execute(task);
+				return true;
+			}
+
+			// Runs queued tasks until every task of the group has finished.
+			void wait(TaskGroup& group) {
+				unsigned id = self();
+				while (group.pending_.load(std::memory_order_acquire) != 0) {
+					if (!run_one(id)) std::this_thread::yield();
+				}
+				if (group.error_) std::rethrow_exception(group.error_);
+			}
+		};
+
+		struct SchedulerConfig {
+			std::mutex lock;
+			std::shared_ptr<Scheduler> instance;
+			unsigned threads = 0;
+			Executor* executor = nullptr;
+		};
+
+		inline SchedulerConfig& scheduler_config() {
+			static SchedulerConfig config;
+			return config;
+		}
+
+		// Number of threads of the shared scheduler, without starting it.
+		inline unsigned default_threads() {
+			SchedulerConfig& config = scheduler_config();
+			std::lock_guard<std::mutex> guard(config.lock);
+			if (config.instance) return config.instance->concurrency();
+			if (config.executor) return config.executor->concurrency() + 1;
+			return config.threads != 0 ? config.threads : hardware_threads();
+		}
+
+		// The scheduler of the calling worker, so that nested parallel sorts share its threads,
+		// else the shared scheduler, started on first use.
+		inline std::shared_ptr<Scheduler> scheduler() {
+			if (Scheduler* s = Scheduler::current_worker()) return s->shared_from_this();
+
+			SchedulerConfig& config = scheduler_config();
+			std::lock_guard<std::mutex> guard(config.lock);
+			if (!config.instance) {
+				unsigned threads = config.threads != 0 ? config.threads : hardware_threads();
+				config.instance = std::make_shared<Scheduler>(threads, config.executor);
+			}
+			return config.instance;
+		}
+
+		// Fork-join handle on the shared scheduler used by the parallel sorting algorithms.
+		// It does not own threads: size() is the number of threads the algorithm should split
+		// its work between, `threads` capped by the scheduler.
+		class TaskPool {
+			std::shared_ptr<Scheduler> scheduler_;
+			unsigned size_;
+
+		public:
+			explicit TaskPool(unsigned threads = 0) : scheduler_(scheduler()) {
+				unsigned n = scheduler_->concurrency();
+				size_ = threads == 0 || threads > n ? n : threads;
+			}
+
+			TaskPool(const TaskPool&) = delete;
+			TaskPool& operator=(const TaskPool&) = delete;
+
+			unsigned size() const {
+				return size_;
+			}
+
+			template<typename F>
+			void spawn(TaskGroup& group, F&& f) {
+				scheduler_->spawn(group, std::forward<F>(f));
+			}
+
+			// Runs queued tasks until every task of the group has finished.
+			void wait(TaskGroup& group) {
+				scheduler_->wait(group);
+			}
+
+			// Calls f(i) for every i in [0, count) and waits for all of them.
+			template<typename F>
+			void parallel_for(std::size_t count, F f) {
+				TaskGroup group;
+				for (std::size_t i = 1; i < count; ++i) spawn(group, [&f, i]() { f(i); });
+				if (count > 0) {
+					try {
+						f(0);
+					}
+					catch (...) {
+						group.fail(std::current_exception());
+					}
+				}
+				wait(group);
+			}
+		};
+	}
+
+	// Sets the number of threads of the shared pool used by the parallel sorts (0 means one
+	// per hardware thread). Sorts already running keep the previous pool.
+	inline void SetParallelThreads(unsigned threads) {
+		_parallel::SchedulerConfig& config = _parallel::scheduler_config();
+		std::shared_ptr<_parallel::Scheduler> old;
+		{
+			std::lock_guard<std::mutex> guard(config.lock);
+			config.threads = threads;
+			old = std::move(config.instance);
+		}
+	}
+
+	// Number of threads the parallel sorts use.
+	inline unsigned ParallelThreads() {
+		return _parallel::default_threads();
+	}
+
+	// Runs the parallel sorts on executor instead of the library threads, nullptr goes back to
+	// the library threads. The executor must outlive the sorts that use it.
+	inline void SetParallelExecutor(Executor* executor) {
+		_parallel::SchedulerConfig& config = _parallel::scheduler_config();
+		std::shared_ptr<_parallel::Scheduler> old;
+		{
+			std::lock_guard<std::mutex> guard(config.lock);
+			config.executor = executor;
+			old = std::move(config.instance);
+		}
+	}
+
+	// Execution policies accepted by the MayanSort wrappers. The std::execution ones are
+	// accepted as well when the standard library provides them.
+	namespace execution {
+		struct sequenced_policy {};
+		struct parallel_policy {};
+		struct parallel_unsequenced_policy {};
+
+		inline constexpr sequenced_policy seq{};
+		inline constexpr parallel_policy par{};
+		inline constexpr parallel_unsequenced_policy par_unseq{};
+
+		template<typename T> struct is_execution_policy : std::false_type {};
+		template<> struct is_execution_policy<sequenced_policy> : std::true_type {};
+		template<> struct is_execution_policy<parallel_policy> : std::true_type {};
+		template<> struct is_execution_policy<parallel_unsequenced_policy> : std::true_type {};
+
+		template<typename T> struct is_parallel_policy : std::false_type {};
+		template<> struct is_parallel_policy<parallel_policy> : std::true_type {};
+		template<> struct is_parallel_policy<parallel_unsequenced_policy> : std::true_type {};
+
+#ifdef __cpp_lib_execution
+		template<> struct is_execution_policy<std::execution::sequenced_policy> : std::true_type {};
+		template<> struct is_execution_policy<std::execution::parallel_policy> : std::true_type {};
+		template<> struct is_execution_policy<std::execution::parallel_unsequenced_policy> : std::true_type {};
+		template<> struct is_parallel_policy<std::execution::parallel_policy> : std::true_type {};
+		template<> struct is_parallel_policy<std::execution::parallel_unsequenced_policy> : std::true_type {};
+#endif
+
+		template<typename T>
+		inline constexpr bool is_execution_policy_v = is_execution_policy<std::remove_cvref_t<T>>::value;
+
+		template<typename T>
+		inline constexpr bool is_parallel_policy_v = is_parallel_policy<std::remove_cvref_t<T>>::value;
+	}
+
+	namespace _parallel {
+		enum {
+			// Smallest chunk sorted by one task on the generic parallel path.
+			min_chunk_size = 1 << 14
+		};
+
+		// Uninitialized storage for n elements. Constructed slots are tracked by the caller,
+		// which must destroy them before the buffer goes away.
+		template<typename T>
+		struct raw_buffer {
+			T* data;
+			std::size_t size;
+
+			explicit raw_buffer(std::size_t n) : data(std::allocator<T>().allocate(n)), size(n) {}
+			~raw_buffer() { std::allocator<T>().deallocate(data, size); }
+
+			raw_buffer(const raw_buffer&) = delete;
+			raw_buffer& operator=(const raw_buffer&) = delete;
+		};
+
+		// Finds how many elements of each sorted run come before output position `rank` in the
+		// stable merge of the runs: ties are ordered by run index, then by position. The runs are
+		// [first + bounds[i], first + bounds[i + 1]). Repeatedly takes the middle element of the
+		// widest remaining interval as a pivot and narrows the intervals with its rank.
+		template<typename Iter, typename Compare>
+		std::vector<std::ptrdiff_t> multiseq_select(Iter first, const std::vector<std::ptrdiff_t>& bounds,
+		                                            std::ptrdiff_t rank, Compare comp) {
+			std::size_t k = bounds.size() - 1;
+			std::vector<std::ptrdiff_t> lo(k, 0), hi(k), cnt(k);
+			for (std::size_t i = 0; i < k; ++i) hi[i] = bounds[i + 1] - bounds[i];
+
+			while (true) {
+				std::size_t w = 0;
+				for (std::size_t i = 1; i < k; ++i) {
+					if (hi[i] - lo[i] > hi[w] - lo[w]) w = i;
+				}
+				if (hi[w] == lo[w]) return lo;
+
+				std::ptrdiff_t m = lo[w] + (hi[w] - lo[w]) / 2;
+				Iter pivot = first + (bounds[w] + m);
+				std::ptrdiff_t total = 0;
+				for (std::size_t i = 0; i < k; ++i) {
+					Iter b = first + bounds[i], e = first + bounds[i + 1];
+					std::ptrdiff_t c;
+					if (i < w) c = std::upper_bound(b, e, *pivot, comp) - b;
+					else if (i > w) c = std::lower_bound(b, e, *pivot, comp) - b;
+					else c = m;
+					cnt[i] = std::min(std::max(c, lo[i]), hi[i]);
+					total += cnt[i];
+				}
+
+				if (total == rank) return cnt;
+				if (total < rank) {
+					lo = cnt;
+					lo[w] = m + 1;
+				}
+				else {
+					hi = cnt;
+				}
+			}
+		}
+
+		// Stably merges the sorted runs [first + bounds[i], first + bounds[i + 1]), bounds[0] == 0,
+		// on all threads of the pool: every thread merges one slice of the output into a buffer,
+		// whose slices are found by multiseq_select, then moves it back.
+		template<typename Iter, typename Compare>
+		void multiway_merge(TaskPool& pool, Iter first, const std::vector<std::ptrdiff_t>& bounds, Compare comp) {
+			typedef typename std::iterator_traits<Iter>::value_type T;
+
+			std::size_t k = bounds.size() - 1;
+			std::ptrdiff_t n = bounds[k];
+			std::size_t parts = pool.size();
+			if (k < 2 || n == 0) return;
+
+			std::vector<std::vector<std::ptrdiff_t> > splits(parts + 1);
+			pool.parallel_for(parts + 1, [&](std::size_t p) {
+				splits[p] = multiseq_select(first, bounds, n * std::ptrdiff_t(p) / std::ptrdiff_t(parts), comp);
+			});
+
+			raw_buffer<T> buffer(n);
+			std::vector<std::ptrdiff_t> built(parts, 0);
+			try {
+				pool.parallel_for(parts, [&](std::size_t p) {
+					std::vector<Iter> cur(k), end(k);
+					std::vector<std::size_t> heap;
+					for (std::size_t i = 0; i < k; ++i) {
+						cur[i] = first + (bounds[i] + splits[p][i]);
+						end[i] = first + (bounds[i] + splits[p + 1][i]);
+						if (cur[i] != end[i]) heap.push_back(i);
+					}
+
+					// Min-heap on (head element, run index).
+					Compare c(comp);
+					auto after = [&](std::size_t a, std::size_t b) {
+						return c(*cur[b], *cur[a]) || (!c(*cur[a], *cur[b]) && b < a);
+					};
+					std::make_heap(heap.begin(), heap.end(), after);
+
+					T* out = buffer.data + n * std::ptrdiff_t(p) / std::ptrdiff_t(parts);
+					while (!heap.empty()) {
+						std::pop_heap(heap.begin(), heap.end(), after);
+						std::size_t i = heap.back();
+						::new (static_cast<void*>(out++)) T(std::move(*cur[i]));
+						++built[p];
+						if (++cur[i] != end[i]) std::push_heap(heap.begin(), heap.end(), after);
+						else heap.pop_back();
+					}
+				});
+			}
+			catch (...) {
+				for (std::size_t p = 0; p < parts; ++p) {
+					std::destroy_n(buffer.data + n * std::ptrdiff_t(p) / std::ptrdiff_t(parts), built[p]);
+				}
+				throw;
+			}
+
+			pool.parallel_for(parts, [&](std::size_t p) {
+				std::ptrdiff_t from = n * std::ptrdiff_t(p) / std::ptrdiff_t(parts);
+				std::ptrdiff_t to = n * std::ptrdiff_t(p + 1) / std::ptrdiff_t(parts);
+				std::move(buffer.data + from, buffer.data + to, first + from);
+				std::destroy(buffer.data + from, buffer.data + to);
+			});
+		}
+
+		// Generic parallel path: sorts one chunk per thread with sorter(first, last, comp), then
+		// merges the chunks. The merge is stable, so a stable sorter gives a stable sort.
+		template<typename Iter, typename Compare, typename Sorter>
+		void chunked_sort(Iter first, Iter last, Compare comp, Sorter sorter, unsigned threads = 0) {
+			std::ptrdiff_t n = last - first;
+			if (threads == 0) threads = default_threads();
+			std::size_t chunks = std::min<std::size_t>(threads, std::size_t(n / min_chunk_size));
+			if (chunks < 2) {
+				sorter(first, last, comp);
+				return;
+			}
+
+			std::vector<std::ptrdiff_t> bounds(chunks + 1);
+			for (std::size_t i = 0; i <= chunks; ++i) bounds[i] = n * std::ptrdiff_t(i) / std::ptrdiff_t(chunks);
+
+			TaskPool pool((unsigned)chunks);
+			pool.parallel_for(chunks, [&](std::size_t i) {
+				sorter(first + bounds[i], first + bounds[i + 1], comp);
+			});
+			multiway_merge(pool, first, bounds, comp);
+		}
+
+		// Runs sorter on the calling thread for a sequenced policy, on the generic parallel path
+		// otherwise.
+		template<typename Policy, typename Iter, typename Compare, typename Sorter>
+		void policy_sort(Policy&&, Iter first, Iter last, Compare comp, Sorter sorter) {
+			if constexpr (execution::is_parallel_policy_v<Policy>) chunked_sort(first, last, comp, sorter);
+			else sorter(first, last, comp);
+		}
+	}
+}
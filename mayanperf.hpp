@@ -0,0 +1,223 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// mayanperf.hpp: Hardware performance counters of sort calls (Linux only).
+// A PerfSession opens the counters of the calling thread once, then Measure() counts one call
+// and keeps a record of it, which WriteCsv() and WriteJson() print:
+//     MayanSort::PerfSession perf;
+//     perf.Measure("GrailSort", v.size(), [&] { MayanSort::GrailSort(v.begin(), v.end()); });
+//     perf.WriteCsv(stdout);
+// Counted are cycles, instructions, branch misses, L1 data, last level cache and data TLB read
+// misses, in user space. A counter the kernel or the CPU does not offer, as under a
+// perf_event_paranoid above 2 or in most virtual machines, reads as -1, and elsewhere than
+// on Linux they all do. Only the calling thread is counted, so the parallel sorts show the
+// work of that thread alone. Counters the CPU had to multiplex are scaled to the whole call.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace MayanSort {
+
+	// Counters of one call, -1 for those that could not be read.
+	struct PerfCounts {
+		double seconds = 0;
+		std::int64_t cycles = -1;
+		std::int64_t instructions = -1;
+		std::int64_t branch_misses = -1;
+		std::int64_t l1d_misses = -1;
+		std::int64_t llc_misses = -1;
+		std::int64_t dtlb_misses = -1;
+	};
+
+	struct PerfRecord {
+		std::string label;
+		std::size_t n;
+		PerfCounts counts;
+	};
+
+	namespace _perf {
+		enum { cycles, instructions, branch_misses, l1d_misses, llc_misses, dtlb_misses, events };
+
+		inline const char* const names[events] = {
+			"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses"
+		};
+
+		inline std::int64_t PerfCounts::* const fields[events] = {
+			&PerfCounts::cycles, &PerfCounts::instructions, &PerfCounts::branch_misses,
+			&PerfCounts::l1d_misses, &PerfCounts::llc_misses, &PerfCounts::dtlb_misses
+		};
+
+#if defined(__linux__)
+		inline std::uint64_t cache_miss(std::uint64_t cache) {
+			return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		}
+
+		// Opens one counter of the calling thread, disabled, or returns -1.
+		inline int open(int event) {
+			perf_event_attr attr = {};
+			attr.size = sizeof attr;
+			switch (event) {
+			case cycles: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+			case instructions: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+			case branch_misses: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+			case l1d_misses: attr.type = PERF_TYPE_HW_CACHE; attr.config = cache_miss(PERF_COUNT_HW_CACHE_L1D); break;
+			case llc_misses: attr.type = PERF_TYPE_HW_CACHE; attr.config = cache_miss(PERF_COUNT_HW_CACHE_LL); break;
+			default: attr.type = PERF_TYPE_HW_CACHE; attr.config = cache_miss(PERF_COUNT_HW_CACHE_DTLB); break;
+			}
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			return int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		}
+#endif
+	}
+
+	// Counters of the calling thread and the records of the calls measured with them. A session
+	// must be used on the thread that created it.
+	class PerfSession {
+		int fds_[_perf::events];
+		std::vector<PerfRecord> records_;
+
+	public:
+		PerfSession() {
+			for (int e = 0; e < _perf::events; ++e) {
+#if defined(__linux__)
+				fds_[e] = _perf::open(e);
+#else
+				fds_[e] = -1;
+#endif
+			}
+		}
+
+		PerfSession(const PerfSession&) = delete;
+		PerfSession& operator=(const PerfSession&) = delete;
+
+		~PerfSession() {
+#if defined(__linux__)
+			for (int fd : fds_)
+				if (fd >= 0) ::close(fd);
+#endif
+		}
+
+		// Whether any counter could be opened.
+		bool Available() const {
+			for (int fd : fds_)
+				if (fd >= 0) return true;
+			return false;
+		}
+
+		// Runs call() with the counters on, keeps a record of it under label and n, and returns
+		// its counts.
+		template<typename F>
+		PerfCounts Measure(std::string label, std::size_t n, F&& call) {
+			typedef std::chrono::steady_clock clock;
+			PerfCounts counts;
+#if defined(__linux__)
+			for (int fd : fds_) {
+				if (fd < 0) continue;
+				::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+			clock::time_point start = clock::now();
+			std::forward<F>(call)();
+			counts.seconds = std::chrono::duration<double>(clock::now() - start).count();
+#if defined(__linux__)
+			for (int fd : fds_)
+				if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+			for (int e = 0; e < _perf::events; ++e) {
+				// Value, time enabled, time running.
+				std::uint64_t values[3];
+				if (fds_[e] < 0 || ::read(fds_[e], values, sizeof values) != ssize_t(sizeof values) || values[2] == 0)
+					continue;
+				double scale = values[2] < values[1] ? double(values[1]) / double(values[2]) : 1.0;
+				counts.*_perf::fields[e] = std::int64_t(double(values[0]) * scale);
+			}
+#endif
+			records_.push_back({ std::move(label), n, counts });
+			return counts;
+		}
+
+		const std::vector<PerfRecord>& Records() const {
+			return records_;
+		}
+
+		void Clear() {
+			records_.clear();
+		}
+
+		// One line per record after a header, with empty fields for counters that could not be
+		// read. Labels are written as they are and should not hold commas.
+		void WriteCsv(std::FILE* out) const {
+			std::fprintf(out, "label,n,seconds");
+			for (const char* name : _perf::names) std::fprintf(out, ",%s", name);
+			std::fprintf(out, "\n");
+			for (const PerfRecord& r : records_) {
+				std::fprintf(out, "%s,%zu,%.9f", r.label.c_str(), r.n, r.counts.seconds);
+				for (std::int64_t PerfCounts::* field : _perf::fields) {
+					if (r.counts.*field < 0) std::fprintf(out, ",");
+					else std::fprintf(out, ",%lld", (long long)(r.counts.*field));
+				}
+				std::fprintf(out, "\n");
+			}
+		}
+
+		// An array of one object per record, with null for counters that could not be read.
+		void WriteJson(std::FILE* out) const {
+			std::fprintf(out, "[");
+			for (std::size_t i = 0; i < records_.size(); ++i) {
+				const PerfRecord& r = records_[i];
+				std::fprintf(out, "%s\n  {\"label\": \"", i ? "," : "");
+				for (char c : r.label) {
+					if (c == '"' || c == '\\') std::fprintf(out, "\\%c", c);
+					else if ((unsigned char)c < 0x20) std::fprintf(out, "\\u%04x", unsigned(c));
+					else std::fputc(c, out);
+				}
+				std::fprintf(out, "\", \"n\": %zu, \"seconds\": %.9f", r.n, r.counts.seconds);
+				for (int e = 0; e < _perf::events; ++e) {
+					std::int64_t value = r.counts.*_perf::fields[e];
+					if (value < 0) std::fprintf(out, ", \"%s\": null", _perf::names[e]);
+					else std::fprintf(out, ", \"%s\": %lld", _perf::names[e], (long long)value);
+				}
+				std::fprintf(out, "}");
+			}
+			std::fprintf(out, "\n]\n");
+		}
+	};
+}
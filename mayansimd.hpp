@@ -0,0 +1,1053 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// mayansimd.hpp: SIMD kernels for arithmetic keys, selected at run time from the CPU features.
+// The kernels are written with the GCC / Clang vector extensions and compiled for SSE4.2, AVX2
+// and AVX-512 through target attributes, so no -m flags are needed and one binary runs on every
+// x86-64 CPU. Other compilers and CPUs use the scalar code. Define MAYANSORT_NO_SIMD to leave
+// the kernels out.
+// The CPU is read once with cpuid. The kernels can be limited to a lower level with
+// SetSimdLevel() or the MAYANSORT_SIMD environment variable (none, sse4.2, avx2 or avx512).
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if !defined(MAYANSORT_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+	&& (defined(__x86_64__) || defined(__i386__)) && defined(__has_builtin)
+#if __has_builtin(__builtin_shufflevector)
+#define MAYANSORT_SIMD 1
+#endif
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MAYANSORT_CPUID 1
+#include <cpuid.h>
+#endif
+
+#ifdef MAYANSORT_SIMD
+#include <immintrin.h>
+#endif
+
+namespace MayanSort {
+
+	// Instruction sets the kernels are compiled for, from the least to the most capable.
+	enum class SimdLevel { none, sse42, avx2, avx512 };
+
+	// What the CPU supports, as far as the kernels are concerned. An instruction set is only
+	// reported if the OS saves the registers it uses as well.
+	struct CpuFeatures {
+		bool sse42 = false;
+		bool avx2 = false;
+		bool avx512 = false; // AVX-512F
+		bool bmi2 = false;
+		std::size_t cacheline = 64;
+	};
+
+	namespace _simd {
+
+		typedef SimdLevel Level;
+
+		inline CpuFeatures detect_cpu() {
+			CpuFeatures cpu;
+#ifdef MAYANSORT_CPUID
+			unsigned a, b, c, d;
+			if (!__get_cpuid(1, &a, &b, &c, &d)) return cpu;
+			cpu.sse42 = (c >> 20) & 1;
+			if ((b >> 8) & 0xff) cpu.cacheline = ((b >> 8) & 0xff) * 8;
+
+			// XCR0 tells which registers the OS saves: bits 1-2 for the ymm registers, 5-7 for
+			// the zmm ones.
+			std::uint64_t xcr0 = 0;
+			if ((c >> 27) & 1) {
+				std::uint32_t lo, hi;
+				__asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+				xcr0 = (std::uint64_t(hi) << 32) | lo;
+			}
+			bool avx = ((c >> 28) & 1) && (xcr0 & 0x06) == 0x06;
+			if (__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+				cpu.avx2 = avx && ((b >> 5) & 1);
+				cpu.avx512 = avx && (xcr0 & 0xe0) == 0xe0 && ((b >> 16) & 1);
+				cpu.bmi2 = (b >> 8) & 1;
+			}
+#endif
+			return cpu;
+		}
+
+		// Features of this CPU, detected once.
+		inline const CpuFeatures& cpu() {
+			static const CpuFeatures detected = detect_cpu();
+			return detected;
+		}
+
+		// Best level of the kernels on this CPU.
+		inline Level best_level() {
+#ifdef MAYANSORT_SIMD
+			const CpuFeatures& f = cpu();
+			if (f.avx512) return Level::avx512;
+			if (f.avx2) return Level::avx2;
+			if (f.sse42) return Level::sse42;
+#endif
+			return Level::none;
+		}
+
+		// Level named by the MAYANSORT_SIMD environment variable, or the best one if it is
+		// not set or not understood.
+		inline Level initial_level() {
+			Level best = best_level();
+			const char* env = std::getenv("MAYANSORT_SIMD");
+			if (env == nullptr) return best;
+			std::string_view name(env);
+			Level wanted = best;
+			if (name == "none" || name == "scalar" || name == "0") wanted = Level::none;
+			else if (name == "sse4.2" || name == "sse42") wanted = Level::sse42;
+			else if (name == "avx2") wanted = Level::avx2;
+			else if (name == "avx512") wanted = Level::avx512;
+			return wanted < best ? wanted : best;
+		}
+
+		inline std::atomic<Level>& active_level() {
+			static std::atomic<Level> active(initial_level());
+			return active;
+		}
+
+		// Level the kernels run at.
+		inline Level level() {
+			return active_level().load(std::memory_order_relaxed);
+		}
+
+		inline void set_level(Level lv) {
+			Level best = best_level();
+			active_level().store(lv < best ? lv : best, std::memory_order_relaxed);
+		}
+
+		// Bytes in a register of the level.
+		inline std::size_t register_bytes(Level lv) {
+			return lv == Level::avx512 ? 64 : lv == Level::avx2 ? 32 : 16;
+		}
+
+		// Cacheline size of this CPU, a power of two.
+		inline std::size_t cacheline_size() {
+			static const std::size_t size = std::has_single_bit(cpu().cacheline) ? cpu().cacheline : 64;
+			return size;
+		}
+
+		// Direction in which Compare orders T: 1 ascending, -1 descending, 0 unknown.
+		template<class Compare, class T> struct compare_direction : std::integral_constant<int, 0> {};
+		template<class T> struct compare_direction<std::less<T>, T> : std::integral_constant<int, 1> {};
+		template<class T> struct compare_direction<std::less<>, T> : std::integral_constant<int, 1> {};
+		template<class T> struct compare_direction<std::ranges::less, T> : std::integral_constant<int, 1> {};
+		template<class T> struct compare_direction<std::greater<T>, T> : std::integral_constant<int, -1> {};
+		template<class T> struct compare_direction<std::greater<>, T> : std::integral_constant<int, -1> {};
+		template<class T> struct compare_direction<std::ranges::greater, T> : std::integral_constant<int, -1> {};
+
+		// Whether the scalar merges of T with Compare select the element to move without a branch:
+		// small, trivially copyable values compared by std::less or std::greater, for which a
+		// comparison is cheap and a select is a conditional move. Random inputs mispredict half
+		// of the branches otherwise.
+		template<class T, class Compare>
+		inline constexpr bool branchless_merge = std::is_trivially_copyable_v<T> && sizeof(T) <= 16
+			&& compare_direction<std::remove_cvref_t<Compare>, T>::value != 0;
+
+		template<class T>
+		concept small_integral = std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 4;
+
+		// Order-preserving mapping of a key to a signed 32 or 64-bit lane, for the keys that have
+		// one. exact is true when keys that compare equal are identical, so that the order of
+		// equal keys cannot be seen and stable sorts may use the kernels too.
+		template<class T>
+		struct lane_key {
+			static constexpr bool supported = false;
+		};
+
+		template<small_integral T>
+		struct lane_key<T> {
+			typedef std::int32_t lane;
+			static constexpr bool supported = true, exact = true;
+
+			static lane encode(T k) {
+				if constexpr (sizeof(T) == 4 && std::is_unsigned_v<T>) return lane(k ^ 0x80000000u);
+				else return lane(k);
+			}
+			static T decode(lane u) {
+				if constexpr (sizeof(T) == 4 && std::is_unsigned_v<T>) return T(std::uint32_t(u) ^ 0x80000000u);
+				else return T(u);
+			}
+		};
+
+		template<class T> requires std::is_integral_v<T> && (sizeof(T) == 8)
+		struct lane_key<T> {
+			typedef std::int64_t lane;
+			static constexpr bool supported = true, exact = true;
+
+			static lane encode(T k) {
+				if constexpr (std::is_unsigned_v<T>) return lane(k ^ (std::uint64_t(1) << 63));
+				else return lane(k);
+			}
+			static T decode(lane u) {
+				if constexpr (std::is_unsigned_v<T>) return T(std::uint64_t(u) ^ (std::uint64_t(1) << 63));
+				else return T(u);
+			}
+		};
+
+		// Negative values get their magnitude bits flipped, so that the bits compare as signed
+		// integers. -0.0 is placed before +0.0, which std::less allows.
+		template<class T> requires std::is_floating_point_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)
+			&& std::numeric_limits<T>::is_iec559
+		struct lane_key<T> {
+			typedef std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t> lane;
+			static constexpr bool supported = true, exact = false;
+
+			static lane flip(lane s) {
+				return lane(s ^ ((s >> (8 * sizeof(lane) - 1)) & std::numeric_limits<lane>::max()));
+			}
+			static lane encode(T k) { return flip(std::bit_cast<lane>(k)); }
+			static T decode(lane u) { return std::bit_cast<T>(flip(u)); }
+		};
+
+		// Pairs of small integers, in the lexicographic order of std::less<std::pair>.
+		template<small_integral A, small_integral B>
+		struct lane_key<std::pair<A, B> > {
+			typedef std::int64_t lane;
+			static constexpr bool supported = true, exact = true;
+
+			static lane encode(const std::pair<A, B>& k) {
+				std::uint32_t low = std::uint32_t(lane_key<B>::encode(k.second)) ^ 0x80000000u;
+				return lane((std::uint64_t(std::uint32_t(lane_key<A>::encode(k.first))) << 32) | low);
+			}
+			static std::pair<A, B> decode(lane u) {
+				return std::pair<A, B>(lane_key<A>::decode(std::int32_t(std::uint64_t(u) >> 32)),
+					lane_key<B>::decode(std::int32_t(std::uint32_t(u) ^ 0x80000000u)));
+			}
+		};
+
+#ifdef MAYANSORT_SIMD
+		// Whether [Iter, Compare] can be handed to the kernels.
+		template<class Iter, class Compare, class T = typename std::iterator_traits<Iter>::value_type>
+		inline constexpr bool kernel_usable = std::contiguous_iterator<Iter> && lane_key<T>::supported
+			&& compare_direction<std::remove_cvref_t<Compare>, T>::value != 0;
+
+#define MAYANSORT_SIMD_INLINE __attribute__((always_inline)) inline
+
+		// A register of L lanes of type E.
+		template<class E, int L>
+		struct Vec {
+			typedef E reg __attribute__((vector_size(sizeof(E) * L)));
+			static constexpr int lanes = L;
+		};
+
+		// out = a with lane i taken from lane i ^ X.
+		template<int X, class R, std::size_t... I>
+		MAYANSORT_SIMD_INLINE void permute_xor(R& out, const R& a, std::index_sequence<I...>) {
+			out = __builtin_shufflevector(a, a, (I ^ X)...);
+		}
+
+		// All ones in the lanes i with i & X set.
+		template<int X, class R, std::size_t... I>
+		MAYANSORT_SIMD_INLINE void lanes_with(R& out, std::index_sequence<I...>) {
+			out = R{ ((I & X) ? -1 : 0)... };
+		}
+
+		// a, b = min(a, b), max(a, b) lane by lane.
+		template<class R>
+		MAYANSORT_SIMD_INLINE void minmax(R& a, R& b) {
+			R lo = a < b ? a : b;
+			b = a < b ? b : a;
+			a = lo;
+		}
+
+		// Compare-exchange of every lane i with lane i ^ X of the same register, the smaller
+		// value going to the lane where bit Y of the index is clear.
+		template<class V, int X, int Y>
+		MAYANSORT_SIMD_INLINE void minmax_lanes(typename V::reg& a) {
+			typedef typename V::reg R;
+			R p, high;
+			permute_xor<X>(p, a, std::make_index_sequence<V::lanes>());
+			lanes_with<Y>(high, std::make_index_sequence<V::lanes>());
+			R lo = a < p ? a : p, hi = a < p ? p : a;
+			a = high ? hi : lo;
+		}
+
+		// Bitonic merge, half-cleaner steps of distance D down to 1 over the N registers of r.
+		template<class V, int N, int D>
+		MAYANSORT_SIMD_INLINE void half_clean(typename V::reg* r) {
+			if constexpr (D >= V::lanes) {
+				constexpr int dr = D / V::lanes;
+				for (int i = 0; i < N; ++i) if (!(i & dr)) minmax(r[i], r[i + dr]);
+			}
+			else {
+				for (int i = 0; i < N; ++i) minmax_lanes<V, D, D>(r[i]);
+			}
+			if constexpr (D > 1) half_clean<V, N, D / 2>(r);
+		}
+
+		// Merges the sorted blocks of M / 2 values into sorted blocks of M, then goes on with
+		// blocks twice as large. Every merge starts by comparing the values of each block in
+		// reverse order, so that all steps sort ascending.
+		template<class V, int N, int M>
+		MAYANSORT_SIMD_INLINE void merge_blocks(typename V::reg* r) {
+			if constexpr (M <= V::lanes) {
+				for (int i = 0; i < N; ++i) minmax_lanes<V, M - 1, M / 2>(r[i]);
+			}
+			else {
+				constexpr int flip = M / V::lanes - 1;
+				for (int i = 0; i < N; ++i) {
+					int j = i ^ flip;
+					if (i < j) {
+						permute_xor<V::lanes - 1>(r[j], r[j], std::make_index_sequence<V::lanes>());
+						minmax(r[i], r[j]);
+						permute_xor<V::lanes - 1>(r[j], r[j], std::make_index_sequence<V::lanes>());
+					}
+				}
+			}
+			if constexpr (M >= 4) half_clean<V, N, M / 4>(r);
+			if constexpr (M < N * V::lanes) merge_blocks<V, N, M * 2>(r);
+		}
+
+		// Sorting network over the N * L values at p.
+		template<class E, int L, int N>
+		MAYANSORT_SIMD_INLINE void network(E* p) {
+			typedef Vec<E, L> V;
+			typename V::reg r[N];
+			__builtin_memcpy(r, p, sizeof(r));
+			merge_blocks<V, N, 2>(r);
+			__builtin_memcpy(p, r, sizeof(r));
+		}
+
+		template<class E, int N>
+		__attribute__((target("sse4.2"))) inline void network_sse42(E* p) {
+			network<E, 16 / sizeof(E), N>(p);
+		}
+
+		template<class E, int N>
+		__attribute__((target("avx2"))) inline void network_avx2(E* p) {
+			network<E, 32 / sizeof(E), N>(p);
+		}
+
+		template<class E, int N>
+		__attribute__((target("avx512f"))) inline void network_avx512(E* p) {
+			network<E, 64 / sizeof(E), N>(p);
+		}
+
+		// Sorts the n lanes at p, n being a power of two from one to eight registers.
+		template<class E>
+		inline void run_network(E* p, std::size_t n, Level lv) {
+			std::size_t regs = n / (register_bytes(lv) / sizeof(E));
+			if (lv == Level::avx512) {
+				switch (regs) {
+				case 1: network_avx512<E, 1>(p); break;
+				case 2: network_avx512<E, 2>(p); break;
+				case 4: network_avx512<E, 4>(p); break;
+				default: network_avx512<E, 8>(p); break;
+				}
+			}
+			else if (lv == Level::avx2) {
+				switch (regs) {
+				case 1: network_avx2<E, 1>(p); break;
+				case 2: network_avx2<E, 2>(p); break;
+				case 4: network_avx2<E, 4>(p); break;
+				default: network_avx2<E, 8>(p); break;
+				}
+			}
+			else {
+				switch (regs) {
+				case 1: network_sse42<E, 1>(p); break;
+				case 2: network_sse42<E, 2>(p); break;
+				case 4: network_sse42<E, 4>(p); break;
+				default: network_sse42<E, 8>(p); break;
+				}
+			}
+		}
+#else
+		template<class Iter, class Compare>
+		inline constexpr bool kernel_usable = false;
+#endif
+
+		// Sorts [begin, end) with a sorting network in the vector registers, if the keys and
+		// the comparator allow it and the range fits in eight registers. Returns false, and
+		// leaves the range alone, otherwise. The quicksorts (pdqsort, nanosort and the
+		// pdqsort of vergesort) try it on every partition before their own small sort, so
+		// only CPUs and keys without a network take that path.
+		template<class Iter, class Compare>
+		inline bool network_sort(Iter begin, Iter end, Compare) {
+#ifdef MAYANSORT_SIMD
+			if constexpr (kernel_usable<Iter, Compare>) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				typedef lane_key<T> K;
+				typedef typename K::lane E;
+				constexpr bool descending = compare_direction<std::remove_cvref_t<Compare>, T>::value < 0;
+
+				std::size_t n = std::size_t(end - begin);
+				Level lv = level();
+				if (lv == Level::none) return false;
+				std::size_t lanes = register_bytes(lv) / sizeof(E);
+				if (n > 8 * lanes) return false;
+				if (n < 2) return true;
+
+				std::size_t padded = lanes;
+				while (padded < n) padded *= 2;
+				alignas(64) E buf[512 / sizeof(E)];
+				T* p = std::to_address(begin);
+				for (std::size_t i = 0; i < n; ++i) {
+					E u = K::encode(p[i]);
+					buf[i] = descending ? E(~u) : u;
+				}
+				for (std::size_t i = n; i < padded; ++i) buf[i] = std::numeric_limits<E>::max();
+				run_network(buf, padded, lv);
+				for (std::size_t i = 0; i < n; ++i) p[i] = K::decode(descending ? E(~buf[i]) : buf[i]);
+				return true;
+			}
+#endif
+			return false;
+		}
+
+#ifdef MAYANSORT_SIMD
+		// Partitioning, as in vqsort: every vector of keys is compared with the pivot, its lanes
+		// are reordered so that the ones going left come first, and it is stored at both write
+		// positions. One vector is held back from each end at the start, so that both write
+		// positions always have a vector's worth of free slots, and the next vector is read from
+		// the end that has less.
+
+		enum {
+			// Vectors read at a time by the partitioning, from the same end. Unrolling measured
+			// 1.5x faster than reading one vector at a time, mostly from fewer mispredicted
+			// choices of the end.
+			partition_unroll = 4
+		};
+
+		template<class T>
+		concept partition_key = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+			&& (sizeof(T) == 4 || sizeof(T) == 8);
+
+		template<class Iter, class Compare, class T = typename std::iterator_traits<Iter>::value_type>
+		inline constexpr bool partition_usable = std::contiguous_iterator<Iter> && partition_key<T>
+			&& compare_direction<std::remove_cvref_t<Compare>, T>::value != 0;
+
+		// For every mask of the lanes going left, the source lane of every output lane, one per
+		// nibble: the lanes going left first, then the others. 64-bit lanes are given as pairs of
+		// 32-bit lanes.
+		template<int Lanes>
+		struct pack_table {
+			std::uint32_t order[1 << Lanes];
+
+			constexpr pack_table() : order() {
+				constexpr int width = 8 / Lanes;
+				for (int m = 0; m < (1 << Lanes); ++m) {
+					int k = 0;
+					for (int pass = 0; pass < 2; ++pass) {
+						for (int i = 0; i < Lanes; ++i) {
+							if (((m >> i) & 1) == pass) continue;
+							for (int w = 0; w < width; ++w, ++k) order[m] |= std::uint32_t(i * width + w) << (4 * k);
+						}
+					}
+				}
+			}
+		};
+
+		template<int Lanes>
+		inline constexpr pack_table<Lanes> pack_order{};
+
+		// Loads and compares only, for the run scanning.
+		template<class T>
+		struct Sse42 {
+			typedef __m128i reg;
+			static constexpr int lanes = 16 / sizeof(T);
+
+			__attribute__((target("sse4.2"))) static void load(reg& v, const T* p) {
+				v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+
+			// Bit i is set if lane i of a is less than lane i of b.
+			__attribute__((target("sse4.2"))) static unsigned less(const reg& a, const reg& b) {
+				if constexpr (std::is_same_v<T, float>) {
+					return unsigned(_mm_movemask_ps(_mm_cmplt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))));
+				}
+				else if constexpr (std::is_floating_point_v<T>) {
+					return unsigned(_mm_movemask_pd(_mm_cmplt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))));
+				}
+				else {
+					reg x = a, y = b;
+					if constexpr (std::is_unsigned_v<T>) {
+						reg sign = sizeof(T) == 4 ? _mm_set1_epi32(std::numeric_limits<std::int32_t>::min())
+							: _mm_set1_epi64x(std::numeric_limits<std::int64_t>::min());
+						x = _mm_xor_si128(x, sign);
+						y = _mm_xor_si128(y, sign);
+					}
+					if constexpr (sizeof(T) == 4) return unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(y, x))));
+					else return unsigned(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(y, x))));
+				}
+			}
+		};
+
+		template<class T>
+		struct Avx2 {
+			typedef __m256i reg;
+			static constexpr int lanes = 32 / sizeof(T);
+
+			__attribute__((target("avx2"))) static void load(reg& v, const T* p) {
+				v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			}
+
+			__attribute__((target("avx2"))) static void set1(reg& v, T x) {
+				if constexpr (sizeof(T) == 4) v = _mm256_set1_epi32(std::bit_cast<std::int32_t>(x));
+				else v = _mm256_set1_epi64x(std::bit_cast<std::int64_t>(x));
+			}
+
+			// Bit i is set if lane i of a is less than lane i of b.
+			__attribute__((target("avx2"))) static unsigned less(const reg& a, const reg& b) {
+				if constexpr (std::is_same_v<T, float>) {
+					return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_LT_OQ)));
+				}
+				else if constexpr (std::is_floating_point_v<T>) {
+					return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_LT_OQ)));
+				}
+				else {
+					reg x = a, y = b;
+					if constexpr (std::is_unsigned_v<T>) {
+						reg sign;
+						set1(sign, T(T(1) << (8 * sizeof(T) - 1)));
+						x = _mm256_xor_si256(x, sign);
+						y = _mm256_xor_si256(y, sign);
+					}
+					if constexpr (sizeof(T) == 4) return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(y, x))));
+					else return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(y, x))));
+				}
+			}
+
+			// Stores the lanes of v set in `left` at l, and the others after as many slots at r.
+			__attribute__((target("avx2"))) static void store_split(T* l, T* r, const reg& v, unsigned left) {
+				__m256i idx = _mm256_srlv_epi32(_mm256_set1_epi32(int(pack_order<lanes>.order[left])),
+					_mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+				__m256i packed = _mm256_permutevar8x32_epi32(v, _mm256_and_si256(idx, _mm256_set1_epi32(7)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(l), packed);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(r), packed);
+			}
+		};
+
+		template<class T>
+		struct Avx512 {
+			typedef __m512i reg;
+			static constexpr int lanes = 64 / sizeof(T);
+
+			__attribute__((target("avx512f"))) static void load(reg& v, const T* p) {
+				v = _mm512_loadu_si512(p);
+			}
+
+			__attribute__((target("avx512f"))) static void set1(reg& v, T x) {
+				if constexpr (sizeof(T) == 4) v = _mm512_set1_epi32(std::bit_cast<std::int32_t>(x));
+				else v = _mm512_set1_epi64(std::bit_cast<std::int64_t>(x));
+			}
+
+			__attribute__((target("avx512f"))) static unsigned less(const reg& a, const reg& b) {
+				if constexpr (std::is_same_v<T, float>) return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_LT_OQ);
+				else if constexpr (std::is_floating_point_v<T>) return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_LT_OQ);
+				else if constexpr (sizeof(T) == 4 && std::is_signed_v<T>) return _mm512_cmplt_epi32_mask(a, b);
+				else if constexpr (sizeof(T) == 4) return _mm512_cmplt_epu32_mask(a, b);
+				else if constexpr (std::is_signed_v<T>) return _mm512_cmplt_epi64_mask(a, b);
+				else return _mm512_cmplt_epu64_mask(a, b);
+			}
+
+			__attribute__((target("avx512f"))) static void store_split(T* l, T* r, const reg& v, unsigned left) {
+				unsigned right = ~left & ((1u << lanes) - 1);
+				int count = std::popcount(left);
+				if constexpr (sizeof(T) == 4) {
+					_mm512_storeu_si512(l, _mm512_maskz_compress_epi32(__mmask16(left), v));
+					_mm512_mask_storeu_epi32(r + count, __mmask16((1u << (lanes - count)) - 1), _mm512_maskz_compress_epi32(__mmask16(right), v));
+				}
+				else {
+					_mm512_storeu_si512(l, _mm512_maskz_compress_epi64(__mmask8(left), v));
+					_mm512_mask_storeu_epi64(r + count, __mmask8((1u << (lanes - count)) - 1), _mm512_maskz_compress_epi64(__mmask8(right), v));
+				}
+			}
+		};
+
+		// Lanes of v that go left of p: v < p, or p > v if Swap, negated if Negate.
+		template<class V, bool Swap, bool Negate>
+		MAYANSORT_SIMD_INLINE unsigned left_lanes(const typename V::reg& v, const typename V::reg& p) {
+			unsigned m = Swap ? V::less(p, v) : V::less(v, p);
+			return Negate ? ~m & ((1u << V::lanes) - 1) : m;
+		}
+
+		template<class V, bool Swap, bool Negate, class T>
+		MAYANSORT_SIMD_INLINE void split_vector(T*& l_store, T*& r_store, const typename V::reg& v, const typename V::reg& p) {
+			unsigned left = left_lanes<V, Swap, Negate>(v, p);
+			int count = std::popcount(left);
+			V::store_split(l_store, r_store, v, left);
+			l_store += count;
+			r_store -= V::lanes - count;
+		}
+
+		// Partitions [first, last), a whole number of at least 2 * U vectors, and returns the
+		// split. U vectors are read at a time from the chosen end.
+		template<class V, int U, bool Swap, bool Negate, class T>
+		inline T* partition_vectors(T* first, T* last, T pivot) {
+			constexpr int L = V::lanes;
+			typename V::reg p, held[2 * U], cur[U];
+			V::set1(p, pivot);
+			for (int u = 0; u < U; ++u) {
+				V::load(held[u], first + u * L);
+				V::load(held[U + u], last - (u + 1) * L);
+			}
+
+			T* l_store = first;
+			T* r_store = last - L;
+			T* left = first + U * L;
+			T* right = last - U * L;
+			while (right - left >= U * L) {
+				if ((r_store + L) - right < left - l_store) {
+					right -= U * L;
+					for (int u = 0; u < U; ++u) V::load(cur[u], right + u * L);
+				}
+				else {
+					for (int u = 0; u < U; ++u) V::load(cur[u], left + u * L);
+					left += U * L;
+				}
+				for (int u = 0; u < U; ++u) split_vector<V, Swap, Negate>(l_store, r_store, cur[u], p);
+			}
+			while (left != right) {
+				if ((r_store + L) - right < left - l_store) {
+					right -= L;
+					V::load(cur[0], right);
+				}
+				else {
+					V::load(cur[0], left);
+					left += L;
+				}
+				split_vector<V, Swap, Negate>(l_store, r_store, cur[0], p);
+			}
+			for (int u = 0; u < 2 * U; ++u) split_vector<V, Swap, Negate>(l_store, r_store, held[u], p);
+			return l_store;
+		}
+
+		template<bool Swap, bool Negate, class T>
+		__attribute__((target("avx2"), flatten)) inline T* partition_avx2(T* first, T* last, T pivot) {
+			return partition_vectors<Avx2<T>, partition_unroll, Swap, Negate>(first, last, pivot);
+		}
+
+		template<bool Swap, bool Negate, class T>
+		__attribute__((target("avx512f"), flatten)) inline T* partition_avx512(T* first, T* last, T pivot) {
+			return partition_vectors<Avx512<T>, partition_unroll, Swap, Negate>(first, last, pivot);
+		}
+#else
+		template<class Iter, class Compare>
+		inline constexpr bool partition_usable = false;
+#endif
+
+		// Partitions [first, last) around pivot: first the keys for which comp(key, pivot) holds
+		// if Strict, else the keys for which comp(pivot, key) does not, then the others. Sets split
+		// to the boundary and returns true, or returns false and leaves the range alone if the
+		// keys, the comparator or the CPU do not allow it or the range is short.
+		template<bool Strict, class Iter, class Compare>
+		inline bool partition(Iter first, Iter last, const typename std::iterator_traits<Iter>::value_type& pivot,
+			Compare comp, Iter& split) {
+#ifdef MAYANSORT_SIMD
+			if constexpr (partition_usable<Iter, Compare>) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				constexpr bool descending = compare_direction<std::remove_cvref_t<Compare>, T>::value < 0;
+
+				// The lanes are packed with a permutation that SSE4.2 does not have.
+				Level lv = level();
+				if (lv < Level::avx2) return false;
+				std::size_t lanes = register_bytes(lv) / sizeof(T);
+				std::size_t n = std::size_t(last - first);
+				if (n < 4 * partition_unroll * lanes) return false;
+
+				// Trim the range to whole vectors.
+				T* l = std::to_address(first);
+				T* r = l + n;
+				for (std::size_t i = n % lanes; i > 0; --i) {
+					if (Strict ? comp(*l, pivot) : !comp(pivot, *l)) ++l;
+					else std::swap(*l, *--r);
+				}
+
+				T* mid = lv == Level::avx512 ? partition_avx512<descending == Strict, !Strict>(l, r, T(pivot))
+					: partition_avx2<descending == Strict, !Strict>(l, r, T(pivot));
+				split = first + (mid - std::to_address(first));
+				return true;
+			}
+#endif
+			return false;
+		}
+
+#ifdef MAYANSORT_SIMD
+		// Merging, as in "Efficient implementation of sorting on multi-core SIMD CPU architecture"
+		// (Chhugani et al.): a block of keys from each side is merged in the registers with a
+		// bitonic network, the lower half is stored and the upper half is merged with the next
+		// block, read from the side whose next key is smaller. When a side runs short, the keys
+		// still in the registers are given back, so that the caller finishes an exact prefix of
+		// the stable merge. Backward merges read both sides from their ends in reverse order.
+
+		enum {
+			// The merge hands back to the caller after reading this many blocks in a row from the
+			// same side, so that a caller that gallops can do so.
+			merge_gallop_blocks = 8
+		};
+
+		// Integers are merged as they are, equal ones cannot be told apart. Floats are merged as
+		// 64-bit lanes of a key and the position in the merge, so that equal keys, including
+		// -0.0 and +0.0, keep their order.
+		template<class T>
+		concept merge_key = (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8))
+			|| (std::is_same_v<T, float> && std::numeric_limits<float>::is_iec559);
+
+		template<class Iter1, class Iter2, class Out, class Compare, class T = typename std::iterator_traits<Iter1>::value_type>
+		inline constexpr bool merge_usable = std::contiguous_iterator<Iter1> && std::contiguous_iterator<Iter2>
+			&& std::contiguous_iterator<Out> && std::is_same_v<T, typename std::iterator_traits<Iter2>::value_type>
+			&& std::is_same_v<T, typename std::iterator_traits<Out>::value_type> && merge_key<T>
+			&& compare_direction<std::remove_cvref_t<Compare>, T>::value != 0;
+
+		// The lanes 0, 1, ..., L - 1.
+		template<class R, std::size_t... I>
+		MAYANSORT_SIMD_INLINE void lanes_iota(R& out, std::index_sequence<I...>) {
+			out = R{ typename std::remove_reference_t<decltype(out[0])>(I)... };
+		}
+
+		// One side of a merge: n keys read in merge order from p on, or from p - 1 down if
+		// Backward, as lanes of E that compare as signed integers, complemented if Flip. base is
+		// the position of the first key in the merge.
+		template<class T, class E, int L, bool Backward, bool Flip>
+		struct MergeSide {
+			typedef typename Vec<E, L>::reg reg;
+			static constexpr bool indexed = std::is_floating_point_v<T>;
+
+			const T* p;
+			std::size_t n;
+			std::uint32_t base;
+
+			MAYANSORT_SIMD_INLINE const T& at(std::size_t k) const {
+				return Backward ? p[-1 - std::ptrdiff_t(k)] : p[k];
+			}
+
+			MAYANSORT_SIMD_INLINE E key(std::size_t k) const {
+				if constexpr (indexed) {
+					std::int32_t s = std::bit_cast<std::int32_t>(at(k));
+					if (s == std::numeric_limits<std::int32_t>::min()) s = 0;
+					s ^= (s >> 31) & std::numeric_limits<std::int32_t>::max();
+					if (Flip) s = ~s;
+					return E((std::uint64_t(std::uint32_t(s)) << 32) | (base + k));
+				}
+				else {
+					E u = E(lane_key<T>::encode(at(k)));
+					return Flip ? E(~u) : u;
+				}
+			}
+
+			// v = keys k to k + L - 1.
+			MAYANSORT_SIMD_INLINE void load(reg& v, std::size_t k) const {
+				const T* src = Backward ? p - std::ptrdiff_t(k) - L : p + k;
+				if constexpr (indexed) {
+					typedef typename Vec<std::int32_t, L>::reg half;
+					half h, zero = {};
+					__builtin_memcpy(&h, src, sizeof(h));
+					h = h == std::numeric_limits<std::int32_t>::min() ? zero : h;
+					h ^= (h >> 31) & std::numeric_limits<std::int32_t>::max();
+					if (Flip) h = ~h;
+					if (Backward) permute_xor<L - 1>(h, h, std::make_index_sequence<L>());
+					reg idx;
+					lanes_iota(idx, std::make_index_sequence<L>());
+					v = (__builtin_convertvector(h, reg) << 32) | (idx + E(base + k));
+				}
+				else {
+					__builtin_memcpy(&v, src, sizeof(v));
+					if (std::is_unsigned_v<T>) v ^= std::numeric_limits<E>::min();
+					if (Flip) v = ~v;
+					if (Backward) permute_xor<L - 1>(v, v, std::make_index_sequence<L>());
+				}
+			}
+		};
+
+		// Writes the keys of v as outputs k to k + L - 1, from out on or from out - 1 down.
+		template<int L, bool Backward, bool Flip, class Side, class T>
+		MAYANSORT_SIMD_INLINE void merge_store(const Side& x, const Side& y, T* out, std::size_t k, const typename Side::reg& r) {
+			typename Side::reg v = r;
+			if constexpr (Side::indexed) {
+				// The keys give back the floats, but for the sign of zero, which is looked up.
+				typedef typename Vec<std::int32_t, L>::reg half;
+				half h = __builtin_convertvector(v >> 32, half);
+				if (Flip) h = ~h;
+				h ^= (h >> 31) & std::numeric_limits<std::int32_t>::max();
+				T* dst = Backward ? out - std::ptrdiff_t(k) - L : out + k;
+				for (int i = 0; i < L; ++i) {
+					if (h[i] == 0) {
+						std::size_t idx = std::uint32_t(v[i]);
+						h[i] = std::bit_cast<std::int32_t>(idx < x.n ? x.at(idx) : y.at(idx - x.n));
+					}
+				}
+				if (Backward) permute_xor<L - 1>(h, h, std::make_index_sequence<L>());
+				__builtin_memcpy(dst, &h, sizeof(h));
+			}
+			else {
+				typedef std::remove_reference_t<decltype(v[0])> E;
+				if (Backward) permute_xor<L - 1>(v, v, std::make_index_sequence<L>());
+				if (Flip) v = ~v;
+				if (std::is_unsigned_v<T>) v ^= std::numeric_limits<E>::min();
+				__builtin_memcpy(Backward ? out - std::ptrdiff_t(k) - L : out + k, &v, sizeof(v));
+			}
+		}
+
+		// Merges the n1 keys of x with the n2 of y, both at least L + 2, into out for as long
+		// as there are blocks left and neither side keeps winning. Returns the number of keys
+		// written, of which taken1 from x.
+		template<class T, class E, int L, bool Backward, bool Flip>
+		MAYANSORT_SIMD_INLINE std::size_t merge_blocks_of(const T* x, std::size_t n1, const T* y, std::size_t n2,
+			T* out, std::size_t& taken1) {
+			typedef Vec<E, L> V;
+			typedef MergeSide<T, E, L, Backward, Flip> Side;
+			Side sx{ x, n1, 0 }, sy{ y, n2, std::uint32_t(n1) };
+
+			typename V::reg r[2];
+			sx.load(r[0], 0);
+			sy.load(r[1], 0);
+			std::size_t k1 = L, k2 = L, done = 0;
+			int same = 0;
+			bool last_y = false;
+			while (true) {
+				merge_blocks<V, 2, 2 * L>(r);
+				merge_store<L, Backward, Flip>(sx, sy, out, done, r[0]);
+				done += L;
+				r[0] = r[1];
+
+				// Keep two keys on each side for the caller, whose loops expect some.
+				bool from_y = sy.key(k2) < sx.key(k1);
+				same = from_y == last_y ? same + 1 : 0;
+				last_y = from_y;
+				if (same >= merge_gallop_blocks) break;
+				if (from_y) {
+					if (n2 - k2 < std::size_t(L) + 2) break;
+					sy.load(r[1], k2);
+					k2 += L;
+				}
+				else {
+					if (n1 - k1 < std::size_t(L) + 2) break;
+					sx.load(r[1], k1);
+					k1 += L;
+				}
+			}
+
+			// Split of the written keys between the sides: the first i keys of x for the smallest
+			// i after which x has the next key, x going first among equal keys.
+			std::size_t lo = done > k2 ? done - k2 : 0, hi = done < k1 ? done : k1;
+			while (lo < hi) {
+				std::size_t mid = lo + (hi - lo) / 2;
+				if (sy.key(done - mid - 1) < sx.key(mid)) hi = mid;
+				else lo = mid + 1;
+			}
+			taken1 = lo;
+			return done;
+		}
+
+		template<bool Backward, bool Flip, class T>
+		__attribute__((target("sse4.2"), flatten)) inline std::size_t merge_sse42(const T* x, std::size_t n1,
+			const T* y, std::size_t n2, T* out, std::size_t& taken1) {
+			return merge_blocks_of<T, typename lane_key<T>::lane, 16 / sizeof(T), Backward, Flip>(x, n1, y, n2, out, taken1);
+		}
+
+		template<bool Backward, bool Flip, class T>
+		__attribute__((target("avx2"), flatten)) inline std::size_t merge_avx2(const T* x, std::size_t n1,
+			const T* y, std::size_t n2, T* out, std::size_t& taken1) {
+			if constexpr (std::is_floating_point_v<T>) return merge_blocks_of<T, std::int64_t, 4, Backward, Flip>(x, n1, y, n2, out, taken1);
+			else return merge_blocks_of<T, typename lane_key<T>::lane, 32 / sizeof(T), Backward, Flip>(x, n1, y, n2, out, taken1);
+		}
+
+		template<bool Backward, bool Flip, class T>
+		__attribute__((target("avx512f"), flatten)) inline std::size_t merge_avx512(const T* x, std::size_t n1,
+			const T* y, std::size_t n2, T* out, std::size_t& taken1) {
+			if constexpr (std::is_floating_point_v<T>) return merge_blocks_of<T, std::int64_t, 8, Backward, Flip>(x, n1, y, n2, out, taken1);
+			else return merge_blocks_of<T, typename lane_key<T>::lane, 64 / sizeof(T), Backward, Flip>(x, n1, y, n2, out, taken1);
+		}
+#else
+		template<class Iter1, class Iter2, class Out, class Compare>
+		inline constexpr bool merge_usable = false;
+#endif
+
+		// Merges the sorted ranges [first1, last1) and [first2, last2) into out, the elements of
+		// the first range going first among equal ones, for as long as neither range keeps winning
+		// and both have more than a block left. Backward merges go from the ends of the ranges and
+		// write from out - 1 down. The second range may be in place, right after the free slots
+		// (right before them if Backward). Sets taken1 and taken2 to the number of elements
+		// written from each range, which are those of the stable merge, and returns true. Returns
+		// false, and writes nothing, if the keys, the comparator or the CPU do not allow it or a
+		// range is short.
+		template<bool Backward, class Iter1, class Iter2, class Out, class Compare>
+		inline bool merge(Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, Out out, Compare,
+			std::size_t& taken1, std::size_t& taken2) {
+#ifdef MAYANSORT_SIMD
+			if constexpr (merge_usable<Iter1, Iter2, Out, Compare>) {
+				typedef typename std::iterator_traits<Iter1>::value_type T;
+				constexpr bool descending = compare_direction<std::remove_cvref_t<Compare>, T>::value < 0;
+				constexpr std::size_t lane_bytes = std::is_floating_point_v<T> ? 8 : sizeof(T);
+
+				Level lv = level();
+				if (lv == Level::none) return false;
+				std::size_t lanes = register_bytes(lv) / lane_bytes;
+				std::size_t n1 = std::size_t(last1 - first1), n2 = std::size_t(last2 - first2);
+				if (n1 < 2 * lanes || n2 < 2 * lanes) return false;
+				if (std::is_floating_point_v<T> && n1 + n2 > std::numeric_limits<std::uint32_t>::max()) return false;
+
+				const T* x = std::to_address(Backward ? last1 : first1);
+				const T* y = std::to_address(Backward ? last2 : first2);
+				T* o = std::to_address(out);
+				std::size_t done;
+				switch (lv) {
+				case Level::avx512: done = merge_avx512<Backward, descending != Backward>(x, n1, y, n2, o, taken1); break;
+				case Level::avx2: done = merge_avx2<Backward, descending != Backward>(x, n1, y, n2, o, taken1); break;
+				default:
+					// Floats would take 64-bit lanes, two to a register, which is slower than
+					// the scalar merges.
+					if constexpr (std::is_floating_point_v<T>) return false;
+					else done = merge_sse42<Backward, descending != Backward>(x, n1, y, n2, o, taken1);
+					break;
+				}
+				taken2 = done - taken1;
+				return true;
+			}
+#endif
+			return false;
+		}
+
+#ifdef MAYANSORT_SIMD
+		// Run scanning: every vector of keys is compared with the vector read one key earlier,
+		// and the first lane in which the order breaks ends the run. Reads are sequential and
+		// unaligned, so a long run is scanned at the speed of memory.
+
+		enum {
+			// Vectors compared at a time by the run scanning before their masks are tested.
+			scan_unroll = 4
+		};
+
+		// Offset from p of the first break in [p, p + n): the first i > 0 such that the lane of
+		// p[i] is set in left_lanes<V, Swap, Negate>(p[i], p[i - 1]). Returns the first offset
+		// not looked at instead if there is no break in the whole vectors.
+		template<class V, bool Swap, bool Negate, class T>
+		inline std::size_t scan_vectors(const T* p, std::size_t n) {
+			constexpr std::size_t L = V::lanes;
+			typename V::reg cur[scan_unroll], prev[scan_unroll];
+			std::size_t i = 1;
+			for (; i + scan_unroll * L <= n; i += scan_unroll * L) {
+				unsigned breaks[scan_unroll], any = 0;
+				for (int u = 0; u < scan_unroll; ++u) {
+					V::load(cur[u], p + i + u * L);
+					V::load(prev[u], p + i + u * L - 1);
+					breaks[u] = left_lanes<V, Swap, Negate>(cur[u], prev[u]);
+					any |= breaks[u];
+				}
+				if (any != 0) {
+					for (int u = 0; ; ++u) {
+						if (breaks[u] != 0) return i + u * L + std::countr_zero(breaks[u]);
+					}
+				}
+			}
+			for (; i + L <= n; i += L) {
+				V::load(cur[0], p + i);
+				V::load(prev[0], p + i - 1);
+				unsigned breaks = left_lanes<V, Swap, Negate>(cur[0], prev[0]);
+				if (breaks != 0) return i + std::countr_zero(breaks);
+			}
+			return i;
+		}
+
+		template<bool Swap, bool Negate, class T>
+		__attribute__((target("sse4.2"), flatten)) inline std::size_t scan_sse42(const T* p, std::size_t n) {
+			return scan_vectors<Sse42<T>, Swap, Negate>(p, n);
+		}
+
+		template<bool Swap, bool Negate, class T>
+		__attribute__((target("avx2"), flatten)) inline std::size_t scan_avx2(const T* p, std::size_t n) {
+			return scan_vectors<Avx2<T>, Swap, Negate>(p, n);
+		}
+
+		template<bool Swap, bool Negate, class T>
+		__attribute__((target("avx512f"), flatten)) inline std::size_t scan_avx512(const T* p, std::size_t n) {
+			return scan_vectors<Avx512<T>, Swap, Negate>(p, n);
+		}
+#endif
+
+		// End of the run of [first, last) that starts at first, first != last: the first i after
+		// first at which the keys stop being non-decreasing under comp, non-increasing if
+		// Descending, strictly so if Strict, or last. Keys that the partitioning handles, compared
+		// by std::less or std::greater, are scanned with vectors, other keys one by one.
+		template<bool Descending, bool Strict, class Iter, class Compare>
+		inline Iter run_end(Iter first, Iter last, Compare comp) {
+			// The run breaks at i when comp(*i, *(i - 1)) != Strict, or comp(*(i - 1), *i) != Strict
+			// if the arguments are swapped.
+			constexpr bool swapped = Descending != Strict;
+			Iter prev = first;
+#ifdef MAYANSORT_SIMD
+			if constexpr (partition_usable<Iter, Compare>) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				constexpr bool descending = compare_direction<std::remove_cvref_t<Compare>, T>::value < 0;
+
+				Level lv = level();
+				if (lv != Level::none) {
+					std::size_t n = std::size_t(last - first);
+					const T* p = std::to_address(first);
+					std::size_t i;
+					switch (lv) {
+					case Level::avx512: i = scan_avx512<swapped != descending, Strict>(p, n); break;
+					case Level::avx2: i = scan_avx2<swapped != descending, Strict>(p, n); break;
+					default: i = scan_sse42<swapped != descending, Strict>(p, n); break;
+					}
+					prev = first + (i - 1);
+				}
+			}
+#endif
+			for (Iter cur = std::next(prev); cur != last; prev = cur++) {
+				if ((swapped ? comp(*prev, *cur) : comp(*cur, *prev)) != Strict) return cur;
+			}
+			return last;
+		}
+
+		// Whether [first, last) is sorted under comp, in one scan of the run at its start.
+		template<class Iter, class Compare>
+		inline bool is_sorted(Iter first, Iter last, Compare comp) {
+			return first == last || run_end<false, false>(first, last, comp) == last;
+		}
+	}
+
+	// Limits the vector kernels to level, to test or compare the code paths. A level this CPU
+	// does not support is lowered to the best one it does.
+	inline void SetSimdLevel(SimdLevel level) {
+		_simd::set_level(level);
+	}
+
+	// Level the vector kernels run at.
+	inline SimdLevel CurrentSimdLevel() {
+		return _simd::level();
+	}
+
+	// Features of this CPU, read once with cpuid.
+	inline const CpuFeatures& DetectedCpuFeatures() {
+		return _simd::cpu();
+	}
+}
@@ -25,7 +25,14 @@
 
 
 #include "mayandef.hpp"
+#include "mayanmem.hpp"
+#include "mayancount.hpp"
+#include "mayanperf.hpp"
+#include "mayantrace.hpp"
+#include "mayanpar.hpp"
+#include "mayansimd.hpp"
 #include <algorithm>
+#include <bit>
 #include <random>
 
 #include "grailsort.hpp"
@@ -45,13 +52,35 @@
 #include "aroot.hpp"
 #include "hayate.hpp"
 #include "sqrtsort.hpp"
+#include "parallel_pdqsort.hpp"
+#include "samplesort.hpp"
+#include "radixsort.hpp"
+#include "msd_radixsort.hpp"
+#include "string_sort.hpp"
+#include "presortedness.hpp"
 
 #include "mayanimpl.hpp"
 
 namespace MayanSort {
     
+    // Sorted check
+    // Every wrapper below returns at once on sorted input (see _SortedExit in mayandef.hpp).
+    // One scan, with vectors for arithmetic keys, see the mayansimd.hpp file.
+    template<typename It, typename Comp> requires std::forward_iterator<It>
+        && std::indirect_strict_weak_order<Comp, It>
+    inline bool IsSorted(It first, It last, Comp comp) {
+        return _simd::is_sorted(first, last, comp);
+    }
+
+    template<typename It> requires std::forward_iterator<It> && std::indirectly_readable<It>
+    inline bool IsSorted(It first, It last) {
+        _CompD;
+        return IsSorted<It, Compare>(first, last, Compare());
+    }
+
     // Intro sort (unstable)
     _SortTpl _SortHead IntroSort(It first, It last, Comp comp) {
+        _SortedExit;
         std::sort<It, Comp>(first, last, comp);
     }
 
@@ -62,6 +91,7 @@ namespace MayanSort {
 
     // Bottom-up merge sort (stable)
     _SortTpl _SortHead MergeSortBottomUp(It first, It last, Comp comp) {
+        _SortedExit;
         std::stable_sort<It, Comp>(first, last, comp);
     }
 
@@ -74,9 +104,16 @@ namespace MayanSort {
     // Implementation: https://github.com/BonzaiThePenguin/WikiSort/blob/master/WikiSort.cpp
     // See the wikisort.h file.
     _SortTpl _SortHead WikiSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(Wiki::Sort(first, last, comp, _ArenaAlloc));
         Wiki::Sort<It, Comp>(first, last, comp);
     }
 
+    _SortTplA _SortHead WikiSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        Wiki::Sort<It, Comp, Alloc>(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead WikiSort(It first, It last) {
         _CompD;
         WikiSort<It, Compare>(first, last, Compare());
@@ -86,6 +123,7 @@ namespace MayanSort {
     // Implementation: https://github.com/orlp/pdqsort/blob/master/pdqsort.h
     // See the pdqsort.hpp file.
     _SortTpl _SortHead PDQSort(It first, It last, Comp comp) {
+        _SortedExit;
         pdqsort(first, last, comp);
     }
 
@@ -95,6 +133,7 @@ namespace MayanSort {
     }
 
     _SortTpl _SortHead PDQSortBranchless(It first, It last, Comp comp) {
+        _SortedExit;
         pdqsort_branchless(first, last, comp);
     }
 
@@ -103,10 +142,64 @@ namespace MayanSort {
         PDQSort<It, Compare>(first, last, Compare());
     }
 
+    // Parallel pattern-defating quicksort (unstable)
+    // Implementation by myself, built on the pdqsort_detail partitioning.
+    // See the parallel_pdqsort.hpp file.
+    _SortTpl _SortHead ParallelPDQSort(It first, It last, Comp comp, unsigned threads) {
+        _SortedExit;
+        parallel_pdqsort(first, last, comp, threads);
+    }
+
+    _SortTpl _SortHead ParallelPDQSort(It first, It last, Comp comp) {
+        ParallelPDQSort<It, Comp>(first, last, comp, 0);
+    }
+
+    _SortTplD _SortHead ParallelPDQSort(It first, It last) {
+        _CompD;
+        ParallelPDQSort<It, Compare>(first, last, Compare());
+    }
+
+    // In-place MSD Radix Sort (unstable)
+    // Implementation by myself, after ska_sort: https://github.com/skarupke/ska_sort
+    // Sorts by key(element): an arithmetic value, a string, or a pair or tuple of those.
+    // See the msd_radixsort.hpp file.
+    template<typename It, typename Key>
+        requires std::random_access_iterator<It> && std::permutable<It>
+            && msd_radix_detail::msd_key<std::remove_cvref_t<std::invoke_result_t<Key&, ItValue<It>&>>>
+    _SortHead InPlaceRadixSort(It first, It last, Key key) {
+        msd_radixsort(first, last, key);
+    }
+
+    template<typename It>
+        requires std::random_access_iterator<It> && std::permutable<It> && msd_radix_detail::msd_key<ItValue<It>>
+    _SortHead InPlaceRadixSort(It first, It last) {
+        InPlaceRadixSort(first, last, std::identity());
+    }
+
+    // String Sort (unstable)
+    // Implementation by myself: multikey quicksort with character caching.
+    // Sorts std::string, std::string_view or const char* ranges, optionally returning the
+    // longest common prefix of every string and the previous one in lcp.
+    // See the string_sort.hpp file.
+    template<typename It>
+        requires std::random_access_iterator<It> && std::permutable<It>
+            && std::convertible_to<const ItValue<It>&, std::string_view>
+    _SortHead StringSort(It first, It last) {
+        string_sort(first, last);
+    }
+
+    template<typename It>
+        requires std::random_access_iterator<It> && std::permutable<It>
+            && std::convertible_to<const ItValue<It>&, std::string_view>
+    _SortHead StringSort(It first, It last, std::vector<std::size_t>& lcp) {
+        string_sort(first, last, lcp);
+    }
+
     // GrailSort (stable)
     // Implementation: https://github.com/HolyGrailSortProject/Rewritten-Grailsort/blob/master/C%2B%2B/Morwenn's%20rewrite%20of%20Summer%20Dragonfly's%20GrailSort/grailsort.h
     // See the grailsort.hpp file.
     _SortTpl _SortHead GrailSort(It first, It last, Comp comp) {
+        _SortedExit;
         grailsort<It, Comp>(first, last, comp);
     }
 
@@ -120,7 +213,8 @@ namespace MayanSort {
     // Implementation: https://github.com/Morwenn/quick_merge_sort/blob/trunk/quick_merge_sort.h%2B%2B
     // See the quick_merge_sort.hpp file.
     _SortTpl _SortHead QuickMergeSort(It first, It last, Comp comp) {
-        quick_merge_sort<It, Comp>(first, last, distance(first, last), comp);
+        _SortedExit;
+        quick_merge_sort<It, Comp>(first, last, std::distance(first, last), comp);
     }
 
     _SortTplD _SortHead QuickMergeSort(It first, It last) {
@@ -136,7 +230,26 @@ namespace MayanSort {
         It mid = first + size / 2;
         MergeSort(first, mid, comp);
         MergeSort(mid, last, comp);
-        std::inplace_merge<It, Comp>(first, mid, last, comp);
+        if (!comp(*mid, *std::prev(mid))) return;
+        if constexpr (_simd::merge_usable<ItValue<It>*, It, It, Comp>) {
+            // Arithmetic keys: the first half is moved out and merged back with vectors while
+            // both halves are long enough (see mayansimd.hpp).
+            std::vector<ItValue<It> > buffer(first, mid);
+            ItValue<It>* a = buffer.data();
+            ItValue<It>* a_last = a + buffer.size();
+            It b = mid, out = first;
+            std::size_t taken1, taken2;
+            while (_simd::merge<false>(a, a_last, b, last, out, comp, taken1, taken2)) {
+                a += taken1;
+                b += taken2;
+                out += taken1 + taken2;
+            }
+            while (a != a_last && b != last) *out++ = comp(*b, *a) ? *b++ : *a++;
+            std::copy(a, a_last, out);
+        }
+        else {
+            std::inplace_merge<It, Comp>(first, mid, last, comp);
+        }
     }
 
     _SortTplD _SortHead MergeSort(It first, It last) {
@@ -147,9 +260,16 @@ namespace MayanSort {
     // Drop Merge Sort (stable)
     // Implementation: https://github.com/adrian17/cpp-drop-merge-sort/blob/master/drop_merge_sort.hpp
     _SortTpl _SortHead DropMergeSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(dmsort(first, last, comp, _ArenaAlloc));
         dmsort<It, Comp>(first, last, comp);
     }
 
+    _SortTplA _SortHead DropMergeSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        dmsort<It, Comp, Alloc>(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead DropMergeSort(It first, It last) {
         _CompD;
         DropMergeSort<It, Compare>(first, last, Compare());
@@ -160,6 +280,7 @@ namespace MayanSort {
 
 
     _SortTpl _SortHead QuickSort(It first, It last, Comp comp) {
+        _SortedExit;
         vergesort::detail::quicksort(first, last, std::distance(first, last), comp);
     }
 
@@ -173,10 +294,11 @@ namespace MayanSort {
     // Implementation: https://github.com/HolyGrailSortProject/Rewritten-Grailsort/blob/master/C%2B%2B/Morwenn's%20rewrite%20of%20Summer%20Dragonfly's%20GrailSort/grailsort.h
     // See the grailsort.hpp file.
     _SortTpl _SortHead LazyStableSort(It first, It last, Comp comp) {
-        grailsort_detail::GrailSort sorter;
+        _SortedExit;
         typedef grailsort_detail::ThreeWayCompare<Comp> CompFunctor;
         CompFunctor compare(std::move(comp));
-        sorter.LazyStableSort<It, CompFunctor>(first, 0, (int)std::distance(first, last), compare);
+        grailsort_detail::GrailSort<ItSize<It>>::template LazyStableSort<It, CompFunctor>(
+            first, 0, std::distance(first, last), compare);
     }
 
     _SortTplD _SortHead LazyStableSort(It first, It last) {
@@ -188,20 +310,51 @@ namespace MayanSort {
     // Implementation: https://github.com/timsort/cpp-TimSort/blob/master/include/gfx/timsort.hpp
     // See the timsort.hpp file.
     _SortTpl _SortHead TimSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(gfx::timsort(first, last, comp, gfx::detail::identity(), _ArenaAlloc));
         gfx::timsort<It, Comp>(first, last, comp);
     }
 
+    _SortTplA _SortHead TimSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        gfx::timsort(first, last, comp, gfx::detail::identity(), alloc);
+    }
+
     _SortTplD _SortHead TimSort(It first, It last) {
         _CompD;
         TimSort<It, Compare>(first, last, Compare());
     }
 
+    // Parallel TimSort (stable)
+    // Implementation by myself, built on the timsort.hpp run detection and merging.
+    // See the timsort.hpp file.
+    _SortTpl _SortHead ParallelTimSort(It first, It last, Comp comp, unsigned threads) {
+        _SortedExit;
+        _ArenaExit(gfx::parallel_timsort(first, last, comp, gfx::detail::identity(), threads, _ArenaAlloc));
+        gfx::parallel_timsort<It, Comp>(first, last, comp, {}, threads);
+    }
+
+    _SortTplA _SortHead ParallelTimSort(It first, It last, Comp comp, unsigned threads, const Alloc& alloc) {
+        _SortedExit;
+        gfx::parallel_timsort(first, last, comp, gfx::detail::identity(), threads, alloc);
+    }
+
+    _SortTpl _SortHead ParallelTimSort(It first, It last, Comp comp) {
+        ParallelTimSort<It, Comp>(first, last, comp, 0);
+    }
+
+    _SortTplD _SortHead ParallelTimSort(It first, It last) {
+        _CompD;
+        ParallelTimSort<It, Compare>(first, last, Compare());
+    }
+
     // GoSort
     // Implementation: https://github.com/golang/go/blob/dev.boringcrypto.go1.18/src/sort/sort.go
 
     // Rewritten for C++
 
     _SortTpl _SortHead GoSort(It first, It last, Comp comp) {
+        _SortedExit;
         gosort::sort_unstable(first, last, comp);
     }
 
@@ -211,6 +364,7 @@ namespace MayanSort {
     }
 
     _SortTpl _SortHead GoStableSort(It first, It last, Comp comp) {
+        _SortedExit;
         gosort::sort_stable(first, last, comp);
     }
 
@@ -221,8 +375,10 @@ namespace MayanSort {
 
     // Dual Pivot Quick Sort
     // Implementation: https://www.geeksforgeeks.org/dual-pivot-quicksort/
+    // Modified to take the pivots from a sample of five. See the mayanimpl.hpp file.
 
     _SortTpl _SortHead QuickSortDualPivot(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_dualsort::dqsort(first, last, comp);
     }
 
@@ -235,6 +391,7 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead BubbleSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_bubbleSort<It, Comp>(first, last, comp);
     }
 
@@ -247,6 +404,7 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead SelectionSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_selection_sort<It, Comp>(first, last, comp);
     }
 
@@ -259,6 +417,7 @@ namespace MayanSort {
     // Insertion Sort
     // Implementation by myself.
     _SortTpl _SortHead InsertSort(It first, It last, Comp comp) {
+        _SortedExit;
         InsertionSort<It, Comp>(first, last, comp);
     }
 
@@ -271,6 +430,7 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead InsertSortBinary(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_binary_insertion_sort<It, Comp>(first, last, comp);
     }
 
@@ -284,6 +444,7 @@ namespace MayanSort {
     // Implementation: https://github.com/Morwenn/vergesort/blob/master/vergesort.h
     // See the vergesort.hpp file.
     _SortTpl _SortHead VergeSort(It first, It last, Comp comp) {
+        _SortedExit;
         vergesort::vergesort<It, Comp>(first, last, comp);
     }
 
@@ -296,6 +457,7 @@ namespace MayanSort {
     // Implementation: https://github.com/MichaelAxtmann/DualPivotQuicksort/blob/master/include/dual_pivot_quicksort.hpp
     // See the dual_pivot_quicksort.hpp file.
     _SortTpl _SortHead QuickSortDualPivotFast(It first, It last, Comp comp) {
+        _SortedExit;
         dual_pivot_quicksort::sort<It, Comp>(first, last, comp);
     }
 
@@ -308,6 +470,7 @@ namespace MayanSort {
     // Implementation: https://github.com/Morwenn/poplar-heap/blob/master/poplar.h
     // See the poplar.hpp file.
     _SortTpl _SortHead PoplarHeapSort(It first, It last, Comp comp) {
+        _SortedExit;
         poplar::make_heap<It, Comp>(first, last, comp);
         poplar::sort_heap<It, Comp>(first, last, comp);
     }
@@ -321,6 +484,7 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead CircleSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::circle_sort(first, last, comp);
     }
 
@@ -333,7 +497,8 @@ namespace MayanSort {
     // Implementation by myself
 
     _SortTpl _SortHead GnomeSort(It first, It last, Comp comp) {
-        _impl::gome_sort(first, last, comp);
+        _SortedExit;
+        _impl::gnome_sort(first, last, comp);
     }
 
     _SortTplD _SortHead GnomeSort(It first, It last) {
@@ -346,6 +511,7 @@ namespace MayanSort {
     // Implementation: https://www.geeksforgeeks.org/cpp-program-for-comb-sort/
 
     _SortTpl _SortHead CombSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_combsort::combsort(first, last, comp);
     }
 
@@ -358,6 +524,7 @@ namespace MayanSort {
     // Implementation: https://www.geeksforgeeks.org/cpp-program-for-shellsort/
 
     _SortTpl _SortHead ShellSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::shell_sort(first, last, comp);
     }
 
@@ -370,6 +537,7 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead TernaryHeapSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_ternarysort::ternary_heap_sort(first, last, comp);
     }
 
@@ -383,9 +551,16 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead PatienceSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(_impl::patience_sort(first, last, comp, _ArenaAlloc));
         _impl::patience_sort(first, last, comp);
     }
 
+    _SortTplA _SortHead PatienceSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        _impl::patience_sort(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead PatienceSort(It first, It last) {
         _CompD;
         PatienceSort<It, Compare>(first, last, Compare());
@@ -394,6 +569,7 @@ namespace MayanSort {
     // Odd Even Sort (unstable)
     // Implementation: https://www.geeksforgeeks.org/odd-even-sort-brick-sort/
     _SortTpl _SortHead OddEvenSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::odd_even_sort(first, last, comp);
     }
 
@@ -406,7 +582,8 @@ namespace MayanSort {
     // Implementation by myself.
 
     _SortTpl _SortHead SillySort(It first, It last, Comp comp) {
-        _impl::_sillySort(first, std::distance(first, last), comp);
+        _SortedExit;
+        _impl::silly_sort(first, last, comp);
     }
 
     _SortTplD _SortHead SillySort(It first, It last) {
@@ -417,6 +594,7 @@ namespace MayanSort {
     // Bitonic Sort (unstable)
     // Implementation: https://www.geeksforgeeks.org/bitonic-sort/
     _SortTpl _SortHead BitonicSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_bitonicsort::bitonic_sort(first, last, comp);
     }
 
@@ -428,6 +606,7 @@ namespace MayanSort {
     // Smooth Sort (unstable)
     // Implementation: https://baobaobear.github.io/post/20191017-weakheapsort/
     _SortTpl _SortHead SmoothSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_smoothsort::smooth_sort<It, Comp>(first, last, comp);
     }
 
@@ -439,9 +618,16 @@ namespace MayanSort {
     // Weak Heap Sort (unstable)
     // Implementation: https://baobaobear.github.io/post/20191017-weakheapsort/
     _SortTpl _SortHead WeakHeapSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(_impl::_weaksort::weakheap_sort(first, last, comp, _ArenaAlloc));
         _impl::_weaksort::weakheap_sort<It, Comp>(first, last, comp);
     }
 
+    _SortTplA _SortHead WeakHeapSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        _impl::_weaksort::weakheap_sort<It, Comp, Alloc>(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead WeakHeapSort(It first, It last) {
         _CompD;
         WeakHeapSort<It, Compare>(first, last, Compare());
@@ -451,6 +637,7 @@ namespace MayanSort {
     // CombSort-11 (unstable)
     // Implementation: https://github.com/electronicarts/EASTL/blob/master/include/EASTL/sort.h#L1767
     _SortTpl _SortHead CombSort11(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_comb11<It, Comp>(first, last, comp);
     }
 
@@ -462,6 +649,7 @@ namespace MayanSort {
     // Double Selection Sort (unstable)
     // Implementation: https://github.com/JoshSilverb/double_ended_sorts/blob/master/double_selection_sort.h
     _SortTpl _SortHead DoubleSelectionSort(It first, It last, Comp comp) {
+        _SortedExit;
         typedef ItValue<It> Item;
         _impl::_double_select_sort<It, Comp>(first, last, comp);
     }
@@ -474,9 +662,16 @@ namespace MayanSort {
     // Shift Sort (unstable)
     // Implementation: https://github.com/JamesQuintero/ShiftSort/blob/master/C%2B%2B/ShiftSort.hpp
     _SortTpl _SortHead ShiftSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(_shiftsort::shiftsort(first, last, comp, _ArenaAlloc));
         _shiftsort::shiftsort(first, last, comp);
     }
 
+    _SortTplA _SortHead ShiftSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        _shiftsort::shiftsort(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead ShiftSort(It first, It last) {
         _CompD;
         ShiftSort<It, Compare>(first, last, Compare());
@@ -485,6 +680,7 @@ namespace MayanSort {
     // Bogo Sort (unstable, slow)
     // Implementation by myself.
     _SortTpl _SortHead BogoSort(It first, It last, Comp comp) {
+        _SortedExit;
         std::random_device rdv;
         while (!std::is_sorted(first, last, comp)) std::shuffle(first, last, rdv);
     }
@@ -497,15 +693,18 @@ namespace MayanSort {
     // BogoBogo Sort (unstable, very slow)
     // Implementation by myself.
     _SortTpl _SortHead BogoBogoSort(It first, It last, Comp comp) {
-        if (std::distance(first, last) < 2) return;
+        _SortedExit;
+        typedef ItSize<It> Size;
+        Size size = std::distance(first, last);
+        if (size < 2) return;
 
         std::random_device rdv;
-        typedef ItSize<It> Size;
         Size index = 2;
 
         while (!std::is_sorted(first, last, comp)) {
             BogoSort(first, first + index, comp);
-            index++;
+            // The whole range was just sorted.
+            if (index++ == size) break;
             if (!std::is_sorted(first, first + index, comp)) {
                 std::shuffle(first, last, rdv);
                 index = 2;
@@ -522,6 +721,7 @@ namespace MayanSort {
     // Stooge Sort (slow)
     // Implementation: https://www.geeksforgeeks.org/the-slowest-sorting-algorithms/
     _SortTpl _SortHead StoogeSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::slowest::stooge_sort(first, last, comp);
     }
 
@@ -533,6 +733,7 @@ namespace MayanSort {
     // Slow Sort (slow)
     // Implementation: https://www.geeksforgeeks.org/the-slowest-sorting-algorithms/
     _SortTpl _SortHead SlowSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::slowest::slow_sort(first, last, comp);
     }
 
@@ -546,6 +747,7 @@ namespace MayanSort {
     // Implementation: https://github.com/ceorron/stable-inplace-sorting-algorithms/blob/master/sort.hpp
     // See the stlib.hpp file.
     _SortTpl _SortHead RotateMergeSort(It first, It last, Comp comp) {
+        _SortedExit;
         stlib::rotate_merge_sort(first, last, comp);
     }
 
@@ -558,6 +760,7 @@ namespace MayanSort {
     // Implementation: https://github.com/ceorron/stable-inplace-sorting-algorithms/blob/master/sort.hpp
     // See the stlib.hpp file.
     _SortTpl _SortHead StableQuickSort(It first, It last, Comp comp) {
+        _SortedExit;
         stlib::stable_quick_sort(first, last, comp);
     }
 
@@ -569,6 +772,7 @@ namespace MayanSort {
     // Double Insertion Sort (stable)
     // Implementation: https://baobaobear.github.io/post/20191009-sorting-2/
     _SortTpl _SortHead DoubleInsertSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::double_insertion_sort(first, last, comp);
     }
 
@@ -580,9 +784,16 @@ namespace MayanSort {
     // Indie Sort (unstable)
     // Implementation: https://github.com/mattreecebentley/plf_indiesort/blob/master/plf_indiesort.h
     _SortTpl _SortHead IndieSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(plf::indiesort(first, last, comp, _ArenaAlloc));
         plf::indiesort<It, Comp>(first, last, comp);
     }
 
+    _SortTplA _SortHead IndieSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        plf::indiesort(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead IndieSort(It first, It last) {
         _CompD;
         IndieSort<It, Compare>(first, last, Compare());
@@ -591,6 +802,7 @@ namespace MayanSort {
     // Nano Sort (unstable)
     // Implementation: https://github.com/zeux/nanosort/blob/master/nanosort.hpp
     _SortTpl _SortHead NanoSort(It first, It last, Comp comp) {
+        _SortedExit;
         nanosort<It, Comp>(first, last, comp);
     }
 
@@ -602,9 +814,16 @@ namespace MayanSort {
     // ARoot Sort (stable)
     // Implementation: https://github.com/kaybee1928/ARoot-Sort/blob/master/ARootSort/ARootSort
     _SortTpl _SortHead ARootSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(ksb::aroot_sort(first, last, comp, _ArenaAlloc));
         ksb::aroot_sort(first, last, comp);
     }
 
+    _SortTplA _SortHead ARootSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        ksb::aroot_sort(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead ARootSort(It first, It last) {
         _CompD;
         ARootSort<It, Compare>(first, last, Compare());
@@ -612,6 +831,7 @@ namespace MayanSort {
 
     // Heap Sort (unstable)
     _SortTpl _SortHead HeapSort(It first, It last, Comp comp) {
+        _SortedExit;
         std::make_heap<It, Comp>(first, last, comp);
         std::sort_heap<It, Comp>(first, last, comp);
     }
@@ -625,6 +845,7 @@ namespace MayanSort {
     // Implementation: https://github.com/EmuraDaisuke/SortingAlgorithm.HayateShiki/blob/master/HayateShiki.h
 
     _SortTpl _SortHead HayateSort(It first, It last, Comp comp) {
+        _SortedExit;
         HayateShiki::sort<It, Comp>(first, last, comp);
     }
 
@@ -636,6 +857,7 @@ namespace MayanSort {
     // Weave Merge Sort (unstable)
     // Implementation by myself.
     _SortTpl _SortHead WeaveMergeSort(It first, It last, Comp comp) {
+        _SortedExit;
         _impl::_wvmergesort::wsort<It, ItValue<It>, ItSize<It>, Comp>(first, last, comp);
     }
 
@@ -647,11 +869,346 @@ namespace MayanSort {
     // Sqrtsort (stable)
     // Implementation: https://github.com/pystraf/sqrt-sort (by myself).
     _SortTpl _SortHead SqrtSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _ArenaExit(sqrtsort::sqrtsort(first, last, comp, _ArenaAlloc));
         sqrtsort::sqrtsort(first, last, comp);
     }
 
+    _SortTplA _SortHead SqrtSort(It first, It last, Comp comp, const Alloc& alloc) {
+        _SortedExit;
+        sqrtsort::sqrtsort(first, last, comp, alloc);
+    }
+
     _SortTplD _SortHead SqrtSort(It first, It last) {
         _CompD;
         SqrtSort<It, Compare>(first, last, Compare());
     }
+
+    // In-place Super Scalar Sample Sort (unstable)
+    // Implementation by myself, after IPS4o: https://github.com/ips4o/ips4o
+    // See the samplesort.hpp file.
+    _SortTpl _SortHead SampleSort(It first, It last, Comp comp) {
+        _SortedExit;
+        samplesort(first, last, comp);
+    }
+
+    _SortTplD _SortHead SampleSort(It first, It last) {
+        _CompD;
+        SampleSort<It, Compare>(first, last, Compare());
+    }
+
+    _SortTpl _SortHead ParallelSampleSort(It first, It last, Comp comp, unsigned threads) {
+        _SortedExit;
+        parallel_samplesort(first, last, comp, threads);
+    }
+
+    _SortTpl _SortHead ParallelSampleSort(It first, It last, Comp comp) {
+        ParallelSampleSort<It, Comp>(first, last, comp, 0);
+    }
+
+    _SortTplD _SortHead ParallelSampleSort(It first, It last) {
+        _CompD;
+        ParallelSampleSort<It, Compare>(first, last, Compare());
+    }
+
+    // LSD Radix Sort (stable)
+    // Implementation by myself.
+    // Sorts by an integral or floating-point key, key(element), instead of a comparison.
+    // See the radixsort.hpp file.
+    template<typename It, typename Key>
+        requires std::random_access_iterator<It> && std::permutable<It>
+            && radix_detail::radix_key<std::remove_cvref_t<std::invoke_result_t<Key&, ItValue<It>&>>>
+    _SortHead RadixSort(It first, It last, Key key) {
+        radixsort(first, last, key);
+    }
+
+    template<typename It>
+        requires std::random_access_iterator<It> && std::permutable<It> && radix_detail::radix_key<ItValue<It>>
+    _SortHead RadixSort(It first, It last) {
+        RadixSort(first, last, std::identity());
+    }
+
+    namespace _budget {
+        // Neighbour pairs sampled by has_runs(), and the most of them that may go against the
+        // majority for the input to count as made of runs.
+        constexpr std::size_t probe_pairs = 64;
+        constexpr std::size_t probe_slack = 4;
+
+        // Whether [first, last) looks made of long runs, ascending or descending, from a few
+        // neighbour pairs spread over it.
+        template<typename It, typename Comp>
+        inline bool has_runs(It first, It last, Comp& comp) {
+            std::size_t n = std::size_t(last - first), up = 0, down = 0;
+            for (std::size_t k = 0; k < probe_pairs; ++k) {
+                It a = first + ItSize<It>((n - 2) * k / (probe_pairs - 1));
+                if (comp(*std::next(a), *a)) ++down;
+                else if (comp(*a, *std::next(a))) ++up;
+            }
+            return up <= probe_slack || down <= probe_slack;
+        }
+
+        // Length of the blocks of GrailSort for n elements, the most of an external buffer it uses.
+        inline std::size_t grail_block(std::size_t n) {
+            std::size_t block = 1;
+            while (block * block < n) block *= 2;
+            return block;
+        }
+    }
+
+    // Stable sort within a memory budget (stable)
+    // Takes at most max_extra_bytes of scratch memory, counted as requested from the allocator.
+    // With room for half the elements it is TimSort if a sample of the input shows runs and
+    // WikiSort with a full cache otherwise. With less, WikiSort takes the largest of its smaller
+    // caches that fits, and below its smallest one GrailSort gets the largest power of two
+    // external buffer that fits, down to none.
+    _SortTpl _SortHead StableSortWithBudget(It first, It last, Comp comp, std::size_t max_extra_bytes) {
+        _SortedExit;
+        typedef ItValue<It> T;
+        typedef gfx::detail::TimSort<It, gfx::detail::projection_compare<Comp, gfx::detail::identity>,
+            _mem::capped_allocator<T>> TimSorter;
+
+        std::size_t n = std::size_t(last - first), left = max_extra_bytes;
+        _mem::capped_allocator<T> alloc(&left);
+        std::size_t tim_bytes = TimSorter::scratchBytes(ItSize<It>(n));
+        if (max_extra_bytes >= tim_bytes && (tim_bytes == 0 || _budget::has_runs(first, last, comp))) {
+            gfx::timsort(first, last, comp, gfx::detail::identity(), alloc);
+        }
+        else if (max_extra_bytes / sizeof(T) >= Wiki::Cache<T>::MinimumSize(n)) {
+            Wiki::Sort(first, last, comp, alloc);
+        }
+        else {
+            std::size_t len = std::bit_floor(std::min(max_extra_bytes / sizeof(T), _budget::grail_block(n)));
+            _mem::buffer<T, _mem::capped_allocator<T>> buffer(alloc);
+            T* ext = buffer.prime(first, len);
+            grailsort(first, last, ext, ext + len, comp);
+        }
+    }
+
+    _SortTplD _SortHead StableSortWithBudget(It first, It last, std::size_t max_extra_bytes) {
+        _CompD;
+        StableSortWithBudget<It, Compare>(first, last, Compare(), max_extra_bytes);
+    }
+
+    // Presortedness probe of AutoSort and AutoStableSort, see ProbeInput().
+    struct SortProbe {
+        std::size_t size = 0;         // Elements.
+        std::size_t element_size = 0; // Bytes per element.
+        std::size_t pairs = 0;        // Neighbour pairs sampled.
+        std::size_t descents = 0;     // Sampled pairs out of order.
+        std::size_t ascents = 0;      // Sampled pairs strictly in order.
+        std::size_t turns = 0;        // Sampled pairs in the other direction than the one before.
+        std::size_t outliers = 0;     // Descents around a single element out of place.
+        bool radix_key = false;       // Arithmetic elements ordered by std::less.
+
+        // Estimated number of non-descending runs.
+        std::size_t runs() const {
+            return pairs ? 1 + std::size_t(double(descents) * double(size - 1) / double(pairs)) : 1;
+        }
+
+        // Estimated number of strictly descending runs.
+        std::size_t descending_runs() const {
+            return pairs ? 1 + std::size_t(double(ascents) * double(size - 1) / double(pairs)) : 1;
+        }
+    };
+
+    // Engines AutoSort and AutoStableSort pick from.
+    enum class AutoEngine {
+        PDQSort,
+        VergeSort,
+        TimSort,
+        DropMergeSort,
+        RadixSort,
+        IndieSort
+    };
+
+    namespace _auto {
+        // Ranges smaller than this are not probed. From this size on the probe costs about 0.5%
+        // of sorting random integers, and nearer 1% at half of it (see bench/autosort.cpp).
+        constexpr std::size_t probe_min = 2048;
+
+        // Neighbour pairs sampled per element, within bounds, in windows of consecutive pairs.
+        constexpr std::size_t probe_ratio = 64;
+        constexpr std::size_t probe_max_pairs = 512;
+        constexpr std::size_t probe_window = 8;
+
+        // Up to one change of direction per run_length sampled pairs makes the input one of
+        // long runs, ascending or descending.
+        constexpr std::size_t run_length = 64;
+
+        // Up to one descent per outlier_spacing pairs, most of them around a single element
+        // out of place, makes the input one of sorted elements with outliers.
+        constexpr std::size_t outlier_spacing = 8;
+
+        // Elements from this size on are sorted through pointers to them by IndieSort.
+        constexpr std::size_t indirect_bytes = 512;
+
+        // Arithmetic ranges from this size on are radix sorted by AutoStableSort. AutoSort
+        // leaves them to PDQSort, whose vector partitioning is faster at every size.
+        constexpr std::size_t radix_min = 2048;
+    }
+
+    // Samples [first, last) for AutoSort: neighbour pairs in windows spread over the range, for
+    // its runs and outliers. Takes at most three comparisons for each of up to 512 pairs, and none
+    // below _auto::probe_min elements.
+    template<typename It, typename Comp>
+        requires std::random_access_iterator<It> && std::indirect_strict_weak_order<Comp, It>
+    SortProbe ProbeInput(It first, It last, Comp comp) {
+        typedef ItValue<It> T;
+        SortProbe probe;
+        std::size_t n = std::size_t(last - first);
+        probe.size = n;
+        probe.element_size = sizeof(T);
+        if constexpr (radix_detail::radix_key<T>)
+            probe.radix_key = _simd::compare_direction<std::remove_cvref_t<Comp>, T>::value > 0;
+        if (n < _auto::probe_min)
+            return probe;
+
+        std::size_t windows = std::clamp(n / _auto::probe_ratio, 2 * _auto::probe_window, _auto::probe_max_pairs)
+            / _auto::probe_window;
+        std::size_t stride = (n - _auto::probe_window - 2) / (windows - 1);
+        for (std::size_t w = 0; w < windows; ++w) {
+            It a = first + ItSize<It>(w * stride);
+            int last_dir = 0;
+            for (std::size_t k = 0; k < _auto::probe_window; ++k, ++a) {
+                It b = std::next(a);
+                int dir = 0;
+                if (comp(*b, *a)) {
+                    dir = -1;
+                    ++probe.descents;
+                    // b dips below a and the next one is back, or a peaks over its neighbours.
+                    if (!comp(*std::next(b), *a) || (a != first && !comp(*b, *std::prev(a))))
+                        ++probe.outliers;
+                }
+                else if (comp(*a, *b)) {
+                    dir = 1;
+                    ++probe.ascents;
+                }
+                if (dir != 0) {
+                    probe.turns += last_dir != 0 && dir != last_dir;
+                    last_dir = dir;
+                }
+            }
+        }
+        probe.pairs = windows * _auto::probe_window;
+        return probe;
+    }
+
+    // The engine AutoSort (AutoStableSort if stable) runs for a probe.
+    inline AutoEngine AutoSortChoose(const SortProbe& probe, bool stable) {
+        if (probe.pairs == 0)
+            return stable ? AutoEngine::TimSort : AutoEngine::PDQSort;
+        if (probe.turns * _auto::run_length <= probe.pairs)
+            return stable ? AutoEngine::TimSort : AutoEngine::VergeSort;
+        // DropMergeSort sorts the elements it drops with an unstable sort.
+        if (probe.descents * _auto::outlier_spacing <= probe.pairs && probe.outliers * 4 >= probe.descents * 3)
+            return stable ? AutoEngine::TimSort : AutoEngine::DropMergeSort;
+        if (stable)
+            return probe.radix_key && probe.size >= _auto::radix_min ? AutoEngine::RadixSort : AutoEngine::TimSort;
+        if (probe.element_size >= _auto::indirect_bytes)
+            return AutoEngine::IndieSort;
+        return AutoEngine::PDQSort;
+    }
+
+    namespace _auto {
+        template<typename It, typename Comp>
+        inline void dispatch(It first, It last, Comp comp, AutoEngine engine) {
+            switch (engine) {
+            case AutoEngine::VergeSort: VergeSort<It, Comp>(first, last, comp); break;
+            case AutoEngine::TimSort: TimSort<It, Comp>(first, last, comp); break;
+            case AutoEngine::DropMergeSort: DropMergeSort<It, Comp>(first, last, comp); break;
+            case AutoEngine::RadixSort:
+                if constexpr (radix_detail::radix_key<ItValue<It>>) RadixSort(first, last);
+                break;
+            case AutoEngine::IndieSort: IndieSort<It, Comp>(first, last, comp); break;
+            default: PDQSort<It, Comp>(first, last, comp); break;
+            }
+        }
+    }
+
+    // Auto Sort (unstable)
+    // Implementation by myself: probes the input (see ProbeInput()) and runs the engine that
+    // suits it, see AutoSortChoose(). Long runs, ascending or descending, go to VergeSort,
+    // sorted input with a few outliers to DropMergeSort, elements of 512 bytes or more to
+    // IndieSort, and the rest to PDQSort.
+    template<typename It, typename Comp> requires std::sortable<It, Comp> && std::random_access_iterator<It>
+    _SortHead AutoSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _auto::dispatch(first, last, comp, AutoSortChoose(ProbeInput(first, last, comp), false));
+    }
+
+    template<typename It> requires std::sortable<It> && std::random_access_iterator<It>
+    _SortHead AutoSort(It first, It last) {
+        _CompD;
+        AutoSort<It, Compare>(first, last, Compare());
+    }
+
+    // Auto Stable Sort (stable)
+    // Same, with RadixSort for arithmetic keys compared by std::less, and TimSort for the rest.
+    template<typename It, typename Comp> requires std::sortable<It, Comp> && std::random_access_iterator<It>
+    _SortHead AutoStableSort(It first, It last, Comp comp) {
+        _SortedExit;
+        _auto::dispatch(first, last, comp, AutoSortChoose(ProbeInput(first, last, comp), true));
+    }
+
+    template<typename It> requires std::sortable<It> && std::random_access_iterator<It>
+    _SortHead AutoStableSort(It first, It last) {
+        _CompD;
+        AutoStableSort<It, Compare>(first, last, Compare());
+    }
+
+    // Execution policy overloads: Name(policy, first, last[, comp]) with policy one of
+    // MayanSort::execution::seq, par, par_unseq (or the std::execution ones).
+    // PDQSort, TimSort and SampleSort use their own parallel versions, the other wrappers
+    // sort one chunk per thread and merge the chunks, see the mayanpar.hpp file.
+    _PolicyWrapNative(PDQSort, ParallelPDQSort)
+    _PolicyWrapNative(PDQSortBranchless, ParallelPDQSort)
+    _PolicyWrapNative(TimSort, ParallelTimSort)
+    _PolicyWrapNative(SampleSort, ParallelSampleSort)
+    _PolicyWrap(IntroSort)
+    _PolicyWrap(MergeSortBottomUp)
+    _PolicyWrap(WikiSort)
+    _PolicyWrap(GrailSort)
+    _PolicyWrap(QuickMergeSort)
+    _PolicyWrap(MergeSort)
+    _PolicyWrap(DropMergeSort)
+    _PolicyWrap(QuickSort)
+    _PolicyWrap(LazyStableSort)
+    _PolicyWrap(GoSort)
+    _PolicyWrap(GoStableSort)
+    _PolicyWrap(QuickSortDualPivot)
+    _PolicyWrap(BubbleSort)
+    _PolicyWrap(SelectionSort)
+    _PolicyWrap(InsertSort)
+    _PolicyWrap(InsertSortBinary)
+    _PolicyWrap(VergeSort)
+    _PolicyWrap(QuickSortDualPivotFast)
+    _PolicyWrap(PoplarHeapSort)
+    _PolicyWrap(CircleSort)
+    _PolicyWrap(GnomeSort)
+    _PolicyWrap(CombSort)
+    _PolicyWrap(ShellSort)
+    _PolicyWrap(TernaryHeapSort)
+    _PolicyWrap(PatienceSort)
+    _PolicyWrap(OddEvenSort)
+    _PolicyWrap(SillySort)
+    _PolicyWrap(BitonicSort)
+    _PolicyWrap(SmoothSort)
+    _PolicyWrap(WeakHeapSort)
+    _PolicyWrap(CombSort11)
+    _PolicyWrap(DoubleSelectionSort)
+    _PolicyWrap(ShiftSort)
+    _PolicyWrap(BogoSort)
+    _PolicyWrap(BogoBogoSort)
+    _PolicyWrap(StoogeSort)
+    _PolicyWrap(SlowSort)
+    _PolicyWrap(RotateMergeSort)
+    _PolicyWrap(StableQuickSort)
+    _PolicyWrap(DoubleInsertSort)
+    _PolicyWrap(IndieSort)
+    _PolicyWrap(NanoSort)
+    _PolicyWrap(ARootSort)
+    _PolicyWrap(HeapSort)
+    _PolicyWrap(HayateSort)
+    _PolicyWrap(WeaveMergeSort)
+    _PolicyWrap(SqrtSort)
 }
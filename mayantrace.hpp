@@ -0,0 +1,201 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// mayantrace.hpp: Phase tracing inside the engines.
+// Built with MAYANSORT_TRACE defined, pdqsort, TimSort and GrailSort call a begin and an end hook
+// around each of their phases, with the number of elements the phase works on:
+//     pdqsort.partition, pdqsort.insertion_sort, pdqsort.partial_insertion_sort, pdqsort.heapsort
+//     timsort.run, timsort.merge
+//     grailsort.collect_keys, grailsort.build_blocks, grailsort.combine_blocks,
+//     grailsort.final_merge, grailsort.lazy_stable_sort
+// and around the whole sort (pdqsort, timsort, grailsort). A timsort.run begins with the elements
+// left to scan and ends with the length of the run it found. Without MAYANSORT_TRACE the hooks
+// compile to nothing. With it and no hooks installed, a phase costs one atomic load.
+// TraceRecorder installs hooks that keep the events of every thread with a timestamp and writes
+// them in the Chrome trace format, for chrome://tracing or Perfetto:
+//     MayanSort::TraceRecorder trace;
+//     MayanSort::PDQSort(v.begin(), v.end());
+//     trace.WriteChromeTrace(file);
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace MayanSort {
+
+	// Called at the beginning and end of each phase, on the thread that runs it. Phases of one
+	// thread nest. The names are string literals.
+	struct TraceHooks {
+		void (*begin)(const char* phase, std::size_t n, void* user);
+		void (*end)(const char* phase, std::size_t n, void* user);
+		void* user;
+	};
+
+	namespace _trace {
+		inline std::atomic<const TraceHooks*>& hooks() {
+			static std::atomic<const TraceHooks*> current(nullptr);
+			return current;
+		}
+
+		// Calls the hooks installed when the phase began around its scope.
+		class phase {
+			const TraceHooks* hooks_;
+			const char* name_;
+			std::size_t n_;
+
+		public:
+			phase(const char* name, std::size_t n)
+				: hooks_(hooks().load(std::memory_order_acquire)), name_(name), n_(n) {
+				if (hooks_) hooks_->begin(name_, n_, hooks_->user);
+			}
+
+			phase(const phase&) = delete;
+			phase& operator=(const phase&) = delete;
+
+			~phase() {
+				if (hooks_) hooks_->end(name_, n_, hooks_->user);
+			}
+
+			// Sets the count given to the end hook.
+			void count(std::size_t n) {
+				n_ = n;
+			}
+		};
+	}
+
+#define _TraceCat2(a, b) a##b
+#define _TraceCat(a, b) _TraceCat2(a, b)
+
+	// Traces the rest of the enclosing scope as a phase of n elements. _TracePhaseAs names the
+	// phase, so that _TraceCount can change its count before it ends.
+#ifdef MAYANSORT_TRACE
+#define _TracePhase(name, n) MayanSort::_trace::phase _TraceCat(_trace_phase_, __LINE__)(name, std::size_t(n))
+#define _TracePhaseAs(var, name, n) MayanSort::_trace::phase var(name, std::size_t(n))
+#define _TraceCount(var, n) var.count(std::size_t(n))
+#else
+#define _TracePhase(name, n) ((void)0)
+#define _TracePhaseAs(var, name, n) ((void)0)
+#define _TraceCount(var, n) ((void)0)
+#endif
+
+	// Installs hooks for the phases that begin from now on, or removes them with nullptr. The
+	// hooks must stay valid until the phases that began with them have ended.
+	inline void SetTraceHooks(const TraceHooks* hooks) {
+		_trace::hooks().store(hooks, std::memory_order_release);
+	}
+
+	// Whether the engines were built with their trace hooks.
+	constexpr bool TraceCompiled() {
+#ifdef MAYANSORT_TRACE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Keeps the phases of every thread while it is alive, as the installed hooks.
+	class TraceRecorder {
+	public:
+		struct Event {
+			const char* phase;
+			std::size_t n;
+			std::int64_t ns; // Since the recorder was created.
+			unsigned thread; // Numbered from 1 in the order threads were first seen.
+			bool begin;
+		};
+
+	private:
+		typedef std::chrono::steady_clock clock;
+
+		TraceHooks hooks_;
+		clock::time_point origin_;
+		std::mutex mutex_;
+		std::vector<Event> events_;
+
+		static unsigned thread_number() {
+			static std::atomic<unsigned> next(1);
+			thread_local unsigned number = next.fetch_add(1, std::memory_order_relaxed);
+			return number;
+		}
+
+		void record(const char* phase, std::size_t n, bool begin) {
+			std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin_).count();
+			unsigned thread = thread_number();
+			std::lock_guard<std::mutex> lock(mutex_);
+			events_.push_back({ phase, n, ns, thread, begin });
+		}
+
+		static void on_begin(const char* phase, std::size_t n, void* user) {
+			static_cast<TraceRecorder*>(user)->record(phase, n, true);
+		}
+
+		static void on_end(const char* phase, std::size_t n, void* user) {
+			static_cast<TraceRecorder*>(user)->record(phase, n, false);
+		}
+
+	public:
+		TraceRecorder() : hooks_{ &on_begin, &on_end, this }, origin_(clock::now()) {
+			SetTraceHooks(&hooks_);
+		}
+
+		TraceRecorder(const TraceRecorder&) = delete;
+		TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+		// Must not end while a sort it traces is running.
+		~TraceRecorder() {
+			const TraceHooks* self = &hooks_;
+			_trace::hooks().compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+		}
+
+		std::vector<Event> Events() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return events_;
+		}
+
+		void Clear() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			events_.clear();
+		}
+
+		// Writes the events as a Chrome trace: one begin and one end event per phase, in
+		// microseconds, with the element count as argument.
+		void WriteChromeTrace(std::FILE* out) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::fprintf(out, "{\"traceEvents\": [");
+			for (std::size_t i = 0; i < events_.size(); ++i) {
+				const Event& e = events_[i];
+				std::fprintf(out, "%s\n  {\"name\": \"%s\", \"cat\": \"mayansort\", \"ph\": \"%s\", \"ts\": %.3f, "
+					"\"pid\": 1, \"tid\": %u, \"args\": {\"n\": %zu}}",
+					i ? "," : "", e.phase, e.begin ? "B" : "E", double(e.ns) / 1000.0, e.thread, e.n);
+			}
+			std::fprintf(out, "\n], \"displayTimeUnit\": \"ns\"}\n");
+		}
+	};
+}
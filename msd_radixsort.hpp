@@ -0,0 +1,247 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// msd_radixsort.hpp: In-place MSD radix sort, in the style of American flag sort and
+// ska_sort (https://github.com/skarupke/ska_sort).
+// Elements are distributed on one key byte at a time, most significant first, by swapping
+// them in place into their buckets, then every bucket is sorted on the next byte. Small
+// buckets go to pdqsort. Keys are arithmetic values, strings, or std::pair / std::tuple of
+// those, which are sorted field by field.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "pdqsort.hpp"
+#include "radixsort.hpp"
+
+namespace MayanSort {
+    namespace msd_radix_detail {
+        enum {
+            // Buckets up to this size are sorted with pdqsort.
+            fallback_threshold = 128
+        };
+
+        template<typename K>
+        concept string_field = !radix_detail::radix_key<K> && std::is_convertible_v<const K&, std::string_view>;
+
+        template<typename K>
+        concept radix_field = radix_detail::radix_key<K> || string_field<K>;
+
+        template<typename K>
+        concept tuple_like = requires { std::tuple_size<K>::value; };
+
+        // Key extraction trait: how many fields a key has and how to get them. A key that is
+        // not a pair or tuple is its own single field.
+        template<typename K>
+        struct key_traits {
+            static constexpr std::size_t fields = 1;
+
+            template<std::size_t I>
+            static const K& get(const K& key) { return key; }
+        };
+
+        template<tuple_like K>
+        struct key_traits<K> {
+            static constexpr std::size_t fields = std::tuple_size<K>::value;
+
+            template<std::size_t I>
+            static const auto& get(const K& key) { return std::get<I>(key); }
+        };
+
+        template<typename K, std::size_t I>
+        using field_type = std::remove_cvref_t<decltype(key_traits<K>::template get<I>(std::declval<const K&>()))>;
+
+        template<typename K, typename Seq = std::make_index_sequence<key_traits<K>::fields> >
+        struct all_fields;
+
+        template<typename K, std::size_t... I>
+        struct all_fields<K, std::index_sequence<I...> > {
+            static constexpr bool value = (radix_field<field_type<K, I> > && ...);
+        };
+
+        template<typename K>
+        concept msd_key = all_fields<K>::value;
+
+        // Order used by the radix passes, for the buckets that are left to pdqsort.
+        template<radix_field F>
+        inline int compare_field(const F& a, const F& b) {
+            if constexpr (string_field<F>) {
+                int c = std::string_view(a).compare(std::string_view(b));
+                return c < 0 ? -1 : c > 0;
+            }
+            else {
+                auto ea = radix_detail::encode(a), eb = radix_detail::encode(b);
+                return ea < eb ? -1 : eb < ea;
+            }
+        }
+
+        template<std::size_t I, typename K>
+        inline bool key_less(const K& a, const K& b) {
+            if constexpr (I == key_traits<K>::fields) {
+                return false;
+            }
+            else {
+                int c = compare_field(key_traits<K>::template get<I>(a), key_traits<K>::template get<I>(b));
+                return c != 0 ? c < 0 : key_less<I + 1>(a, b);
+            }
+        }
+
+        template<class Iter, class Key>
+        class Sorter {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            typedef std::remove_cvref_t<std::invoke_result_t<Key&, T&> > K;
+            typedef key_traits<K> traits;
+
+            Key& key_;
+
+            // Bucket of field I at byte depth. A string that ends before depth goes to bucket 0,
+            // in front of the others.
+            template<std::size_t I>
+            std::size_t digit(Iter it, std::size_t depth) {
+                typedef field_type<K, I> F;
+                decltype(auto) k = std::invoke(key_, *it);
+                const F& f = traits::template get<I>(k);
+                if constexpr (string_field<F>) {
+                    std::string_view s(f);
+                    return depth < s.size() ? std::size_t(static_cast<unsigned char>(s[depth])) + 1 : 0;
+                }
+                else {
+                    return std::size_t(radix_detail::encode(f) >> (8 * (sizeof(F) - 1 - depth))) & 0xff;
+                }
+            }
+
+            void small_sort(Iter begin, Iter end) {
+                pdqsort(begin, end, [this](T& a, T& b) {
+                    return key_less<0>(std::invoke(key_, a), std::invoke(key_, b));
+                });
+            }
+
+        public:
+            explicit Sorter(Key& key) : key_(key) {}
+
+            // Sorts [begin, end) by fields I.. of the key, the fields before I and the first
+            // `depth` bytes of field I being the same for every element. The largest bucket is
+            // handled by the loop and the others by recursion, so the recursion is O(log n) deep.
+            template<std::size_t I>
+            void sort(Iter begin, Iter end, std::size_t depth) {
+                if constexpr (I < traits::fields) {
+                    typedef field_type<K, I> F;
+                    constexpr bool is_string = string_field<F>;
+                    constexpr std::size_t radix = is_string ? 257 : 256;
+
+                    while (true) {
+                        std::size_t n = std::size_t(end - begin);
+                        if (n < 2) return;
+                        if (n <= fallback_threshold) {
+                            small_sort(begin, end);
+                            return;
+                        }
+                        if constexpr (!is_string) {
+                            if (depth == sizeof(F)) {
+                                sort<I + 1>(begin, end, 0);
+                                return;
+                            }
+                        }
+
+                        std::size_t counts[radix] = {};
+                        for (Iter it = begin; it != end; ++it) ++counts[digit<I>(it, depth)];
+
+                        std::size_t first = digit<I>(begin, depth);
+                        if (counts[first] == n) {
+                            if (is_string && first == 0) {
+                                sort<I + 1>(begin, end, 0);
+                                return;
+                            }
+                            ++depth;
+                            continue;
+                        }
+
+                        // In-place permutation as in ska_sort: every element of the unsorted
+                        // part of a bucket is swapped to the head of its own bucket, and the
+                        // sweep is repeated over the unfinished buckets. The swaps of one sweep
+                        // do not depend on each other, unlike in American flag sort.
+                        std::size_t heads[radix], tails[radix], todo[radix];
+                        std::size_t sum = 0, todo_count = 0;
+                        for (std::size_t b = 0; b < radix; ++b) {
+                            heads[b] = sum;
+                            sum += counts[b];
+                            tails[b] = sum;
+                            if (counts[b] != 0) todo[todo_count++] = b;
+                        }
+                        while (todo_count > 1) {
+                            std::size_t kept = 0;
+                            for (std::size_t t = 0; t < todo_count; ++t) {
+                                std::size_t b = todo[t];
+                                for (std::size_t i = heads[b], e = tails[b]; i < e; ++i) {
+                                    std::iter_swap(begin + i, begin + heads[digit<I>(begin + i, depth)]++);
+                                }
+                                if (heads[b] < tails[b]) todo[kept++] = b;
+                            }
+                            todo_count = kept;
+                        }
+
+                        std::size_t largest = first;
+                        for (std::size_t b = 0; b < radix; ++b) {
+                            if (counts[b] > counts[largest]) largest = b;
+                        }
+                        for (std::size_t b = 0; b < radix; ++b) {
+                            if (b == largest || counts[b] < 2) continue;
+                            Iter bb = begin + (tails[b] - counts[b]), be = begin + tails[b];
+                            if (is_string && b == 0) sort<I + 1>(bb, be, 0);
+                            else sort<I>(bb, be, depth + 1);
+                        }
+
+                        Iter lb = begin + (tails[largest] - counts[largest]), le = begin + tails[largest];
+                        if (is_string && largest == 0) {
+                            sort<I + 1>(lb, le, 0);
+                            return;
+                        }
+                        begin = lb;
+                        end = le;
+                        ++depth;
+                    }
+                }
+            }
+        };
+    }
+
+    // Sorts [begin, end) in place by key(element), an arithmetic value, a string, or a pair or
+    // tuple of those. Unstable, uses O(log n) memory.
+    template<class Iter, class Key>
+    inline void msd_radixsort(Iter begin, Iter end, Key key) {
+        msd_radix_detail::Sorter<Iter, Key> sorter(key);
+        sorter.template sort<0>(begin, end, 0);
+    }
+
+    template<class Iter>
+    inline void msd_radixsort(Iter begin, Iter end) {
+        msd_radixsort(begin, end, std::identity());
+    }
+}
@@ -41,6 +41,8 @@
 #include <assert.h>
 #include <stddef.h>
 
+#include "mayansimd.hpp"
+
 #ifdef _MSC_VER
 #define NANOSORT_NOINLINE __declspec(noinline)
 #define NANOSORT_UNLIKELY(c) (c)
@@ -95,15 +97,15 @@ namespace MayanSort {
             T e3 = first[(n >> 2) * 3];
             T e4 = first[n - 1];
 
-            if (comp(e1, e0)) swap(e1, e0);
-            if (comp(e4, e3)) swap(e4, e3);
-            if (comp(e3, e0)) swap(e3, e0);
+            if (comp(e1, e0)) nanosort_detail::swap(e1, e0);
+            if (comp(e4, e3)) nanosort_detail::swap(e4, e3);
+            if (comp(e3, e0)) nanosort_detail::swap(e3, e0);
 
-            if (comp(e1, e4)) swap(e1, e4);
-            if (comp(e2, e1)) swap(e2, e1);
-            if (comp(e3, e2)) swap(e2, e3);
+            if (comp(e1, e4)) nanosort_detail::swap(e1, e4);
+            if (comp(e2, e1)) nanosort_detail::swap(e2, e1);
+            if (comp(e3, e2)) nanosort_detail::swap(e2, e3);
 
-            if (comp(e2, e1)) swap(e2, e1);
+            if (comp(e2, e1)) nanosort_detail::swap(e2, e1);
 
             return e2;
         }
@@ -112,9 +114,11 @@ namespace MayanSort {
         template <typename T, typename It, typename Compare>
         It partition(T pivot, It first, It last, Compare comp) {
             It res = first;
+            if (_simd::partition<true>(first, last, pivot, comp, res)) return res;
+
             for (It it = first; it != last; ++it) {
                 bool r = comp(*it, pivot);
-                swap(*res, *it);
+                nanosort_detail::swap(*res, *it);
                 res += r;
             }
             return res;
@@ -124,9 +128,11 @@ namespace MayanSort {
         template <typename T, typename It, typename Compare>
         It partition_rev(T pivot, It first, It last, Compare comp) {
             It res = first;
+            if (_simd::partition<false>(first, last, pivot, comp, res)) return res;
+
             for (It it = first; it != last; ++it) {
                 bool r = comp(pivot, *it);
-                swap(*res, *it);
+                nanosort_detail::swap(*res, *it);
                 res += !r;
             }
             return res;
@@ -146,13 +152,13 @@ namespace MayanSort {
                 next = comp(heap[next], heap[root * 2 + 2]) ? root * 2 + 2 : next;
 
                 if (next == root) break;
-                swap(heap[root], heap[next]);
+                nanosort_detail::swap(heap[root], heap[next]);
                 root = next;
             }
 
             if (root == last && root * 2 + 1 < count &&
                 comp(heap[root], heap[root * 2 + 1])) {
-                swap(heap[root], heap[root * 2 + 1]);
+                nanosort_detail::swap(heap[root], heap[root * 2 + 1]);
             }
         }
 
@@ -169,7 +175,7 @@ namespace MayanSort {
             }
 
             for (size_t i = count - 1; i > 0; --i) {
-                swap(heap[0], heap[i]);
+                nanosort_detail::swap(heap[0], heap[i]);
                 heap_sift(heap, i, 0, comp);
             }
         }
@@ -181,14 +187,14 @@ namespace MayanSort {
             for (size_t i = n; i > 1; i -= 2) {
                 T x = NANOSORT_MOVE(first[0]);
                 T y = NANOSORT_MOVE(first[1]);
-                if (comp(y, x)) swap(y, x);
+                if (comp(y, x)) nanosort_detail::swap(y, x);
 
                 for (size_t j = 2; j < i; j++) {
                     T z = NANOSORT_MOVE(first[j]);
 
-                    if (comp(x, z)) swap(x, z);
-                    if (comp(y, z)) swap(y, z);
-                    if (comp(y, x)) swap(y, x);
+                    if (comp(x, z)) nanosort_detail::swap(x, z);
+                    if (comp(y, z)) nanosort_detail::swap(y, z);
+                    if (comp(y, x)) nanosort_detail::swap(y, x);
 
                     first[j - 2] = NANOSORT_MOVE(z);
                 }
@@ -201,6 +207,9 @@ namespace MayanSort {
         template <typename T, typename It, typename Compare>
         void sort(It first, It last, size_t limit, Compare comp) {
             for (;;) {
+                // Partitions the network refuses go on to small_sort or to partitioning.
+                if (_simd::network_sort(first, last, comp)) return;
+
                 if (last - first < 16) {
                     small_sort<T>(first, last, comp);
                     return;
@@ -236,6 +245,11 @@ namespace MayanSort {
 
     }  // namespace nanosort_detail
 
+    namespace _simd {
+        template <typename T>
+        struct compare_direction<nanosort_detail::Less, T> : std::integral_constant<int, 1> {};
+    }
+
     template <typename It, typename Compare>
     void nanosort(It first, It last, Compare comp) {
         typedef typename nanosort_detail::IteratorTraits<It>::value_type T;
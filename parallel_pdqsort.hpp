@@ -0,0 +1,268 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// parallel_pdqsort.hpp: Multi-threaded pattern-defeating quicksort.
+// The recursion is the one of pdqsort_detail::pdqsort_loop, but both halves of a large
+// partition are sorted as separate tasks, and the largest partitions are split between
+// all threads instead of being done by one.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pdqsort.hpp"
+#include "mayanpar.hpp"
+
+namespace MayanSort {
+    namespace pdqsort_detail {
+        enum {
+            // Partitions below this size are handed to the sequential pdqsort_loop.
+            parallel_sequential_threshold = 1 << 14,
+
+            // Partitions above this size are partitioned by all threads together.
+            parallel_partition_threshold = 1 << 17,
+
+            // Smallest piece of a parallel partition given to one thread.
+            parallel_partition_chunk = 1 << 14
+        };
+
+        // Partitions [first, last) around pivot, elements equal to the pivot go right. Returns
+        // the partition point and whether any element was moved.
+        template<class Iter, class T, class Compare>
+        inline std::pair<Iter, bool> partition_chunk(Iter first, Iter last, const T& pivot, Compare comp) {
+            bool moved = false;
+            while (true) {
+                while (first != last && comp(*first, pivot)) ++first;
+                do {
+                    if (first == last) return std::make_pair(first, moved);
+                } while (!comp(*--last, pivot));
+                std::iter_swap(first, last);
+                moved = true;
+                ++first;
+            }
+        }
+
+        // Same contract as partition_right, but the work is split between the threads of pool.
+        // Every thread partitions its own chunk, then the elements that ended up on the wrong
+        // side of the global partition point are swapped across in parallel.
+        template<class Iter, class Compare>
+        inline std::pair<Iter, bool> parallel_partition_right(_parallel::TaskPool& pool,
+                                                              Iter begin, Iter end, Compare comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+            typedef std::pair<diff_t, diff_t> span_t;
+
+            T pivot(std::move(*begin));
+            Iter first = begin + 1;
+            diff_t size = end - first;
+
+            std::size_t chunks = std::min<std::size_t>(pool.size(), size / parallel_partition_chunk);
+            if (chunks < 1) chunks = 1;
+            diff_t chunk_size = (size + diff_t(chunks) - 1) / diff_t(chunks);
+
+            std::vector<diff_t> mids(chunks);
+            std::vector<char> moved(chunks);
+            pool.parallel_for(chunks, [&](std::size_t i) {
+                Iter b = first + std::min<diff_t>(size, diff_t(i) * chunk_size);
+                Iter e = first + std::min<diff_t>(size, diff_t(i + 1) * chunk_size);
+                std::pair<Iter, bool> r = partition_chunk(b, e, pivot, comp);
+                mids[i] = r.first - first;
+                moved[i] = r.second;
+            });
+
+            diff_t l_size = 0;
+            for (std::size_t i = 0; i < chunks; ++i) {
+                l_size += mids[i] - std::min<diff_t>(size, diff_t(i) * chunk_size);
+            }
+
+            // Collect the misplaced spans: large elements left of l_size and small elements right
+            // of it. Both sides hold the same number of elements.
+            std::vector<span_t> wrong_l, wrong_r;
+            std::vector<diff_t> pre_l(1, 0), pre_r(1, 0);
+            for (std::size_t i = 0; i < chunks; ++i) {
+                diff_t b = std::min<diff_t>(size, diff_t(i) * chunk_size);
+                diff_t e = std::min<diff_t>(size, diff_t(i + 1) * chunk_size);
+                diff_t lo = mids[i], hi = std::min(e, l_size);
+                if (lo < hi) {
+                    wrong_l.push_back(span_t(lo, hi - lo));
+                    pre_l.push_back(pre_l.back() + (hi - lo));
+                }
+                lo = std::max(b, l_size), hi = mids[i];
+                if (lo < hi) {
+                    wrong_r.push_back(span_t(lo, hi - lo));
+                    pre_r.push_back(pre_r.back() + (hi - lo));
+                }
+            }
+
+            diff_t num_wrong = pre_l.back();
+            bool already_partitioned = num_wrong == 0
+                && std::find(moved.begin(), moved.end(), char(1)) == moved.end();
+
+            if (num_wrong > 0) {
+                std::size_t parts = std::min<std::size_t>(pool.size(), num_wrong / parallel_partition_chunk + 1);
+                pool.parallel_for(parts, [&](std::size_t p) {
+                    diff_t from = num_wrong * diff_t(p) / diff_t(parts);
+                    diff_t to = num_wrong * diff_t(p + 1) / diff_t(parts);
+                    std::size_t il = std::upper_bound(pre_l.begin(), pre_l.end(), from) - pre_l.begin() - 1;
+                    std::size_t ir = std::upper_bound(pre_r.begin(), pre_r.end(), from) - pre_r.begin() - 1;
+                    diff_t ol = from - pre_l[il], or_ = from - pre_r[ir];
+                    while (from < to) {
+                        diff_t n = std::min(to - from, std::min(wrong_l[il].second - ol, wrong_r[ir].second - or_));
+                        std::swap_ranges(first + (wrong_l[il].first + ol), first + (wrong_l[il].first + ol + n),
+                                         first + (wrong_r[ir].first + or_));
+                        from += n; ol += n; or_ += n;
+                        if (ol == wrong_l[il].second) ++il, ol = 0;
+                        if (or_ == wrong_r[ir].second) ++ir, or_ = 0;
+                    }
+                });
+            }
+
+            // Put the pivot in the right place.
+            Iter pivot_pos = begin + l_size;
+            if (l_size > 0) *begin = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+
+            return std::make_pair(pivot_pos, already_partitioned);
+        }
+
+        // Parallel version of pdqsort_loop. The left partition is forked as a task on group, the
+        // right one is handled by the loop. Small partitions go to the sequential pdqsort_loop.
+        template<class Iter, class Compare, bool Branchless>
+        inline void parallel_pdqsort_loop(_parallel::TaskPool& pool, _parallel::TaskGroup& group,
+                                          Iter begin, Iter end, Compare comp, int bad_allowed,
+                                          bool leftmost = true) {
+            typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+
+            while (true) {
+                diff_t size = end - begin;
+
+                if (size < parallel_sequential_threshold) {
+                    pdqsort_loop<Iter, Compare, Branchless>(begin, end, comp, bad_allowed, leftmost);
+                    return;
+                }
+
+                // Pseudomedian of 9, the partition is always above ninther_threshold here.
+                diff_t s2 = size / 2;
+                sort3(begin, begin + s2, end - 1, comp);
+                sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+                sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+                sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+                std::iter_swap(begin, begin + s2);
+
+                if (!leftmost && !comp(*(begin - 1), *begin)) {
+                    begin = partition_left(begin, end, comp) + 1;
+                    continue;
+                }
+
+                std::pair<Iter, bool> part_result =
+                    size >= parallel_partition_threshold && pool.size() > 1
+                    ? parallel_partition_right(pool, begin, end, comp)
+                    : Branchless ? partition_right_branchless(begin, end, comp)
+                    : partition_right(begin, end, comp);
+                Iter pivot_pos = part_result.first;
+                bool already_partitioned = part_result.second;
+
+                diff_t l_size = pivot_pos - begin;
+                diff_t r_size = end - (pivot_pos + 1);
+                bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+                if (highly_unbalanced) {
+                    if (--bad_allowed == 0) {
+                        std::make_heap(begin, end, comp);
+                        std::sort_heap(begin, end, comp);
+                        return;
+                    }
+
+                    if (l_size >= insertion_sort_threshold) {
+                        std::iter_swap(begin, begin + l_size / 4);
+                        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+
+                        if (l_size > ninther_threshold) {
+                            std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                            std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                            std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                            std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                        }
+                    }
+
+                    if (r_size >= insertion_sort_threshold) {
+                        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+                        std::iter_swap(end - 1, end - r_size / 4);
+
+                        if (r_size > ninther_threshold) {
+                            std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                            std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                            std::iter_swap(end - 2, end - (1 + r_size / 4));
+                            std::iter_swap(end - 3, end - (2 + r_size / 4));
+                        }
+                    }
+                }
+                else {
+                    if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
+                        && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+                }
+
+                pool.spawn(group, [&pool, &group, begin, pivot_pos, comp, bad_allowed, leftmost]() {
+                    parallel_pdqsort_loop<Iter, Compare, Branchless>(
+                        pool, group, begin, pivot_pos, comp, bad_allowed, leftmost);
+                });
+                begin = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+    }
+
+    // Sorts [begin, end) with pdqsort on `threads` threads of the shared pool (0 means all).
+    template<class Iter, class Compare>
+    inline void parallel_pdqsort(Iter begin, Iter end, Compare comp, unsigned threads = 0) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        constexpr bool branchless =
+            pdqsort_detail::is_default_compare<typename std::decay<Compare>::type>::value &&
+            std::is_arithmetic<T>::value;
+
+        if (threads == 0) threads = _parallel::default_threads();
+        if (threads == 1 || end - begin < pdqsort_detail::parallel_sequential_threshold) {
+            pdqsort(begin, end, comp);
+            return;
+        }
+
+        _parallel::TaskPool pool(threads);
+        _parallel::TaskGroup group;
+        pool.spawn(group, [&]() {
+            pdqsort_detail::parallel_pdqsort_loop<Iter, Compare, branchless>(
+                pool, group, begin, end, comp, pdqsort_detail::log2(end - begin));
+        });
+        pool.wait(group);
+    }
+
+    template<class Iter>
+    inline void parallel_pdqsort(Iter begin, Iter end) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        parallel_pdqsort(begin, end, std::less<T>());
+    }
+}
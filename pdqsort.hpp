@@ -49,6 +49,9 @@
 #include <utility>
 #include <iterator>
 
+#include "mayansimd.hpp"
+#include "mayantrace.hpp"
+
 #if __cplusplus >= 201103L
 #include <cstdint>
 #include <type_traits>
@@ -74,8 +77,9 @@ namespace MayanSort {
             // Must be multiple of 8 due to loop unrolling, and < 256 to fit in unsigned char.
             block_size = 64,
 
-            // Cacheline size, assumes power of two.
-            cacheline_size = 64
+            // Largest cacheline size the offset buffers are aligned to. The actual size is
+            // detected at run time (see mayansimd.hpp).
+            max_cacheline_size = 128
 
         };
 
@@ -185,7 +189,8 @@ namespace MayanSort {
 #else
             std::size_t ip = reinterpret_cast<std::size_t>(p);
 #endif
-            ip = (ip + cacheline_size - 1) & -cacheline_size;
+            std::size_t line = std::min<std::size_t>(_simd::cacheline_size(), max_cacheline_size);
+            ip = (ip + line - 1) & ~(line - 1);
             return reinterpret_cast<T*>(ip);
         }
 
@@ -219,6 +224,7 @@ namespace MayanSort {
         // insertion_sort_threshold long. Uses branchless partitioning.
         template<class Iter, class Compare>
         inline std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Compare comp) {
+            _TracePhase("pdqsort.partition", end - begin);
             typedef typename std::iterator_traits<Iter>::value_type T;
 
             // Move pivot into local for speed.
@@ -242,11 +248,15 @@ namespace MayanSort {
                 std::iter_swap(first, last);
                 ++first;
 
+                // Arithmetic keys are partitioned with vector compares and stores if the CPU
+                // allows it (see mayansimd.hpp), which leaves nothing to the blocks below.
+                if (_simd::partition<true>(first, last, pivot, comp, first)) last = first;
+
                 // The following branchless partitioning is derived from "BlockQuicksort: How Branch
                 // Mispredictions dont affect Quicksort" by Stefan Edelkamp and Armin Weiss, but
                 // heavily micro-optimized.
-                unsigned char offsets_l_storage[block_size + cacheline_size];
-                unsigned char offsets_r_storage[block_size + cacheline_size];
+                unsigned char offsets_l_storage[block_size + max_cacheline_size];
+                unsigned char offsets_r_storage[block_size + max_cacheline_size];
                 unsigned char* offsets_l = align_cacheline(offsets_l_storage);
                 unsigned char* offsets_r = align_cacheline(offsets_r_storage);
 
@@ -348,6 +358,7 @@ namespace MayanSort {
         // insertion_sort_threshold long.
         template<class Iter, class Compare>
         inline std::pair<Iter, bool> partition_right(Iter begin, Iter end, Compare comp) {
+            _TracePhase("pdqsort.partition", end - begin);
             typedef typename std::iterator_traits<Iter>::value_type T;
 
             // Move pivot into local for speed.
@@ -392,6 +403,7 @@ namespace MayanSort {
         // performance, no block quicksort is applied here for simplicity.
         template<class Iter, class Compare>
         inline Iter partition_left(Iter begin, Iter end, Compare comp) {
+            _TracePhase("pdqsort.partition", end - begin);
             typedef typename std::iterator_traits<Iter>::value_type T;
 
             T pivot(PDQSORT_PREFER_MOVE(*begin));
@@ -425,8 +437,12 @@ namespace MayanSort {
             while (true) {
                 diff_t size = end - begin;
 
+                // Vector sorting network first, insertion sort for what it does not take.
+                if (_simd::network_sort(begin, end, comp)) return;
+
                 // Insertion sort is faster for small arrays.
                 if (size < insertion_sort_threshold) {
+                    _TracePhase("pdqsort.insertion_sort", size);
                     if (leftmost) insertion_sort(begin, end, comp);
                     else unguarded_insertion_sort(begin, end, comp);
                     return;
@@ -469,6 +485,7 @@ namespace MayanSort {
                 if (highly_unbalanced) {
                     // If we had too many bad partitions, switch to heapsort to guarantee O(n log n).
                     if (--bad_allowed == 0) {
+                        _TracePhase("pdqsort.heapsort", size);
                         std::make_heap(begin, end, comp);
                         std::sort_heap(begin, end, comp);
                         return;
@@ -501,8 +518,11 @@ namespace MayanSort {
                 else {
                     // If we were decently balanced and we tried to sort an already partitioned
                     // sequence try to use insertion sort.
-                    if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
-                        && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+                    if (already_partitioned) {
+                        _TracePhase("pdqsort.partial_insertion_sort", size);
+                        if (partial_insertion_sort(begin, pivot_pos, comp)
+                            && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+                    }
                 }
 
                 // Sort the left partition first using recursion and do tail recursion elimination for
@@ -518,6 +538,7 @@ namespace MayanSort {
     template<class Iter, class Compare>
     inline void pdqsort(Iter begin, Iter end, Compare comp) {
         if (begin == end) return;
+        _TracePhase("pdqsort", end - begin);
 
 #if __cplusplus >= 201103L
         pdqsort_detail::pdqsort_loop<Iter, Compare,
@@ -539,6 +560,7 @@ namespace MayanSort {
     template<class Iter, class Compare>
     inline void pdqsort_branchless(Iter begin, Iter end, Compare comp) {
         if (begin == end) return;
+        _TracePhase("pdqsort", end - begin);
         pdqsort_detail::pdqsort_loop<Iter, Compare, true>(
             begin, end, comp, pdqsort_detail::log2(end - begin));
     }
@@ -299,6 +299,19 @@ namespace MayanSort {
                     return;
                 }
 
+                // The next poplar is merged with as many poplars as the bit trick gives, with one
+                // more element for each: when they are not all there, push the rest one by one
+                poplar_diff_t merges = 0;
+                for (auto i = ((poplar_level + 1) & -(poplar_level + 1)) >> 1; i != 0; i >>= 1) {
+                    ++merges;
+                }
+                if (poplar_diff_t(std::distance(next, last)) < small_poplar_size + merges) {
+                    for (auto end = next; end != last;) {
+                        poplar::push_heap(first, ++end, compare);
+                    }
+                    return;
+                }
+
                 it = next;
                 std::advance(next, small_poplar_size);
                 ++poplar_level;
@@ -0,0 +1,325 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// presortedness.hpp: Measures of presortedness, how far a range is from being sorted.
+// After "A survey of adaptive sorting algorithms" (V. Estivill-Castro, D. Wood). Every measure
+// is 0 on a sorted range and grows with its disorder:
+//     Runs: descents, neighbours out of order. O(n).
+//     Inv:  inversions, pairs of elements out of order. O(n log n).
+//     Rem:  fewest elements to remove to leave a sorted sequence. O(n log n).
+//     Osc:  most pairs of neighbours that strictly enclose one element. O(n log n).
+//     Dis:  longest distance between the two elements of an inversion. O(n).
+//     Max:  longest distance from an element to its place in the stably sorted range. O(n log n).
+// The O(n log n) measures rank the elements with one stable sort of their indices. They have
+// sampled versions for large ranges, which take the measure of an ordered random subsequence and
+// scale it to the whole range. Profile() takes all the measures at once.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "mayansimd.hpp"
+
+namespace MayanSort {
+    namespace presort_detail {
+        enum : std::size_t {
+            // Elements of the subsequence the sampled measures are taken on.
+            sample_size = std::size_t(1) << 16,
+
+            // Profile() takes the sampled measures for ranges larger than this.
+            exact_limit = std::size_t(1) << 20
+        };
+
+        template<class Iter>
+        using diff_t = typename std::iterator_traits<Iter>::difference_type;
+
+        // Dense ranks of the elements of [first, last): equivalent elements share one, and a
+        // smaller element has a smaller one. order receives the indices in stable sorted order.
+        template<class Iter, class Compare>
+        void rank(Iter first, Iter last, Compare& comp, std::vector<std::size_t>& ranks, std::vector<std::size_t>& order) {
+            std::size_t n = std::size_t(last - first);
+            order.resize(n);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [first, &comp](std::size_t a, std::size_t b) {
+                return comp(first[diff_t<Iter>(a)], first[diff_t<Iter>(b)]);
+            });
+
+            ranks.resize(n);
+            std::size_t r = 0;
+            for (std::size_t k = 0; k < n; ++k) {
+                if (k > 0 && comp(first[diff_t<Iter>(order[k - 1])], first[diff_t<Iter>(order[k])])) ++r;
+                ranks[order[k]] = r;
+            }
+        }
+
+        // Inversions, counted with a Fenwick tree of the ranks seen so far.
+        inline std::uint64_t inversions(const std::vector<std::size_t>& ranks) {
+            std::size_t n = ranks.size();
+            std::vector<std::size_t> tree(n + 1, 0);
+            std::uint64_t inv = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                // Elements before i with a rank up to ranks[i].
+                std::size_t not_greater = 0;
+                for (std::size_t k = ranks[i] + 1; k > 0; k &= k - 1) not_greater += tree[k];
+                inv += i - not_greater;
+                for (std::size_t k = ranks[i] + 1; k <= n; k += k & (~k + 1)) ++tree[k];
+            }
+            return inv;
+        }
+
+        // Elements out of a longest non-decreasing subsequence, found by patience sorting.
+        inline std::uint64_t removals(const std::vector<std::size_t>& ranks) {
+            std::vector<std::size_t> tails;
+            for (std::size_t r : ranks) {
+                std::vector<std::size_t>::iterator it = std::upper_bound(tails.begin(), tails.end(), r);
+                if (it == tails.end()) tails.push_back(r);
+                else *it = r;
+            }
+            return ranks.size() - tails.size();
+        }
+
+        // Every pair of neighbours of ranks lo < hi encloses the ranks in (lo, hi): they are
+        // added to a difference array over the ranks, whose prefix sums count the pairs
+        // enclosing every rank.
+        inline std::uint64_t oscillation(const std::vector<std::size_t>& ranks) {
+            std::size_t n = ranks.size();
+            std::vector<std::int64_t> diff(n + 1, 0);
+            for (std::size_t i = 1; i < n; ++i) {
+                std::size_t lo = std::min(ranks[i - 1], ranks[i]), hi = std::max(ranks[i - 1], ranks[i]);
+                if (hi > lo + 1) {
+                    ++diff[lo + 1];
+                    --diff[hi];
+                }
+            }
+            std::int64_t enclosing = 0, osc = 0;
+            for (std::size_t r = 0; r < n; ++r) {
+                enclosing += diff[r];
+                osc = std::max(osc, enclosing);
+            }
+            return std::uint64_t(osc);
+        }
+
+        inline std::uint64_t displacement(const std::vector<std::size_t>& order) {
+            std::size_t max = 0;
+            for (std::size_t k = 0; k < order.size(); ++k) {
+                max = std::max(max, k > order[k] ? k - order[k] : order[k] - k);
+            }
+            return max;
+        }
+
+        // The measures of [first, last) that need its ranks.
+        struct ranked {
+            std::uint64_t inv, rem, osc, max;
+        };
+
+        template<class Iter, class Compare>
+        ranked ranked_measures(Iter first, Iter last, Compare& comp) {
+            std::vector<std::size_t> ranks, order;
+            rank(first, last, comp, ranks, order);
+            return { inversions(ranks), removals(ranks), oscillation(ranks), displacement(order) };
+        }
+
+        // Iterators to an ordered random subsequence of m of the n elements at first, one drawn in
+        // each of m equal strata. The generator is seeded with n, so that the same range always
+        // gets the same estimates.
+        template<class Iter>
+        std::vector<Iter> sample(Iter first, std::size_t n, std::size_t m) {
+            std::mt19937_64 rng(n);
+            std::vector<Iter> s(m);
+            for (std::size_t k = 0; k < m; ++k) {
+                std::size_t lo = k * n / m, hi = (k + 1) * n / m;
+                s[k] = first + diff_t<Iter>(lo + rng() % (hi - lo));
+            }
+            return s;
+        }
+
+        // The ranked measures of a sample of m elements, scaled to n: Inv by the ratio of the
+        // numbers of pairs, the others by n / m.
+        template<class Iter, class Compare>
+        ranked sampled_measures(Iter first, Iter last, Compare& comp, std::size_t m) {
+            std::size_t n = std::size_t(last - first);
+            if (m >= n || m < 2) return ranked_measures(first, last, comp);
+
+            std::vector<Iter> s = sample(first, n, m);
+            auto indirect = [&comp](Iter a, Iter b) { return comp(*a, *b); };
+            ranked r = ranked_measures(s.begin(), s.end(), indirect);
+            double pairs = (double(n) * double(n - 1)) / (double(m) * double(m - 1)), scale = double(n) / double(m);
+            return { std::uint64_t(double(r.inv) * pairs + 0.5), std::uint64_t(double(r.rem) * scale + 0.5),
+                     std::uint64_t(double(r.osc) * scale + 0.5), std::uint64_t(double(r.max) * scale + 0.5) };
+        }
+    }
+
+    // Runs: number of descents, neighbours out of order, one less than the number of maximal
+    // non-descending runs. Scans the runs as VergeSort does.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderRuns(Iter first, Iter last, Compare comp = Compare()) {
+        std::uint64_t descents = 0;
+        if (first == last) return 0;
+        while ((first = _simd::run_end<false, false>(first, last, comp)) != last) ++descents;
+        return descents;
+    }
+
+    // Number of runs as TimSort and VergeSort find them: maximal non-descending runs and strictly
+    // descending ones, which they reverse.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t MonotonicRuns(Iter first, Iter last, Compare comp = Compare()) {
+        std::uint64_t runs = 0;
+        while (first != last) {
+            Iter next = std::next(first);
+            if (next != last && comp(*next, *first)) first = _simd::run_end<true, true>(first, last, comp);
+            else first = _simd::run_end<false, false>(first, last, comp);
+            ++runs;
+        }
+        return runs;
+    }
+
+    // Inv: number of pairs of elements out of order.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderInv(Iter first, Iter last, Compare comp = Compare()) {
+        std::vector<std::size_t> ranks, order;
+        presort_detail::rank(first, last, comp, ranks, order);
+        return presort_detail::inversions(ranks);
+    }
+
+    // Rem: fewest elements whose removal leaves the range sorted, the size of the range less the
+    // length of its longest non-descending subsequence.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderRem(Iter first, Iter last, Compare comp = Compare()) {
+        std::vector<std::size_t> ranks, order;
+        presort_detail::rank(first, last, comp, ranks, order);
+        return presort_detail::removals(ranks);
+    }
+
+    // Osc: largest number of pairs of neighbours a and b with a < x < b or b < x < a, for any
+    // element x.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderOsc(Iter first, Iter last, Compare comp = Compare()) {
+        std::vector<std::size_t> ranks, order;
+        presort_detail::rank(first, last, comp, ranks, order);
+        return presort_detail::oscillation(ranks);
+    }
+
+    // Dis: largest j - i with first[j] < first[i]. The elements that can start such a pair are
+    // the prefix maxima and the ones that can end it the suffix minima, both are scanned once.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderDis(Iter first, Iter last, Compare comp = Compare()) {
+        std::size_t n = std::size_t(last - first);
+        if (n < 2) return 0;
+        std::vector<Iter> prefix_max(n), suffix_min(n);
+        prefix_max[0] = first;
+        for (std::size_t i = 1; i < n; ++i) {
+            Iter it = first + presort_detail::diff_t<Iter>(i);
+            prefix_max[i] = comp(*prefix_max[i - 1], *it) ? it : prefix_max[i - 1];
+        }
+        suffix_min[n - 1] = std::prev(last);
+        for (std::size_t i = n - 1; i-- > 0;) {
+            Iter it = first + presort_detail::diff_t<Iter>(i);
+            suffix_min[i] = comp(*it, *suffix_min[i + 1]) ? it : suffix_min[i + 1];
+        }
+
+        std::size_t dis = 0;
+        for (std::size_t i = 0, j = 0; i < n && j < n;) {
+            if (comp(*suffix_min[j], *prefix_max[i])) {
+                if (j > i) dis = std::max(dis, j - i);
+                ++j;
+            }
+            else ++i;
+        }
+        return dis;
+    }
+
+    // Max: largest distance between the position of an element and its position in the stably
+    // sorted range.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t DisorderMax(Iter first, Iter last, Compare comp = Compare()) {
+        std::vector<std::size_t> ranks, order;
+        presort_detail::rank(first, last, comp, ranks, order);
+        return presort_detail::displacement(order);
+    }
+
+    // Estimates of Inv, Rem, Osc and Max from an ordered random subsequence of samples elements,
+    // exact if the range is not larger. Rem and Inv are close for samples in the thousands, Osc
+    // and Max, which depend on single elements, only give an order of magnitude.
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t SampledInv(Iter first, Iter last, Compare comp = Compare(), std::size_t samples = presort_detail::sample_size) {
+        return presort_detail::sampled_measures(first, last, comp, samples).inv;
+    }
+
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t SampledRem(Iter first, Iter last, Compare comp = Compare(), std::size_t samples = presort_detail::sample_size) {
+        return presort_detail::sampled_measures(first, last, comp, samples).rem;
+    }
+
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t SampledOsc(Iter first, Iter last, Compare comp = Compare(), std::size_t samples = presort_detail::sample_size) {
+        return presort_detail::sampled_measures(first, last, comp, samples).osc;
+    }
+
+    template<class Iter, class Compare = std::less<>>
+    inline std::uint64_t SampledMax(Iter first, Iter last, Compare comp = Compare(), std::size_t samples = presort_detail::sample_size) {
+        return presort_detail::sampled_measures(first, last, comp, samples).max;
+    }
+
+    // All the measures of a range, see Profile().
+    struct SortProfile {
+        std::uint64_t size = 0;           // Elements.
+        std::uint64_t monotonic_runs = 0; // Runs as TimSort and VergeSort find them.
+        std::uint64_t runs = 0;           // Runs: descents.
+        std::uint64_t inv = 0;            // Inv: inversions.
+        std::uint64_t rem = 0;            // Rem: elements out of a longest sorted subsequence.
+        std::uint64_t osc = 0;            // Osc: oscillation.
+        std::uint64_t dis = 0;            // Dis: longest inversion.
+        std::uint64_t max = 0;            // Max: longest displacement.
+        bool sampled = false;             // Inv, Rem, Osc and Max are estimates.
+    };
+
+    // Profiles [first, last) for logging next to the time to sort it. Runs and Dis are exact,
+    // Inv, Rem, Osc and Max too for up to a million elements and estimated from a sample of
+    // 65536 above (see SampledInv()). Takes about as long as sorting the range, or its sample.
+    template<class Iter, class Compare = std::less<>>
+    inline SortProfile Profile(Iter first, Iter last, Compare comp = Compare()) {
+        SortProfile profile;
+        std::size_t n = std::size_t(last - first);
+        profile.size = n;
+        profile.monotonic_runs = MonotonicRuns(first, last, comp);
+        profile.runs = DisorderRuns(first, last, comp);
+        profile.dis = DisorderDis(first, last, comp);
+
+        profile.sampled = n > presort_detail::exact_limit;
+        presort_detail::ranked r = profile.sampled
+            ? presort_detail::sampled_measures(first, last, comp, presort_detail::sample_size)
+            : presort_detail::ranked_measures(first, last, comp);
+        profile.inv = r.inv;
+        profile.rem = r.rem;
+        profile.osc = r.osc;
+        profile.max = r.max;
+        return profile;
+    }
+}
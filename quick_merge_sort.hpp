@@ -340,7 +340,7 @@ namespace MayanSort {
         std::random_access_iterator_tag)
         -> RandomAccessIterator
     {
-        std::nth_element(first, first + nth_pos, last);
+        std::nth_element(first, first + nth_pos, last, std::move(comp));
         return first + nth_pos;
     }
 
@@ -0,0 +1,271 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// radixsort.hpp: Stable LSD radix sort on integral and floating-point keys.
+// Keys are mapped to unsigned integers of the same width that compare the same way, then
+// sorted digit by digit from the lowest one with 8, 11 or 16-bit digits, moving the elements
+// between the range and a scratch buffer. The histograms of all digits are counted in one
+// pass first, which also finds the digits that are the same for every key: their passes are
+// skipped. Ranges larger than the cache are first split on their top byte (a stable MSD
+// pass), so that the LSD passes stay in cache.
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MayanSort {
+    namespace radix_detail {
+        enum {
+            // Ranges up to this size are insertion sorted.
+            insertion_sort_threshold = 64,
+
+            // Ranges up to this many bytes are sorted with LSD passes, larger ones are split
+            // with an MSD pass first.
+            block_bytes = 1 << 19
+        };
+
+        template<typename K>
+        concept radix_key = (std::is_integral_v<K> && sizeof(K) <= 8)
+            || std::is_same_v<K, float> || std::is_same_v<K, double>;
+
+        template<std::size_t N> struct uint_of;
+        template<> struct uint_of<1> { typedef std::uint8_t type; };
+        template<> struct uint_of<2> { typedef std::uint16_t type; };
+        template<> struct uint_of<4> { typedef std::uint32_t type; };
+        template<> struct uint_of<8> { typedef std::uint64_t type; };
+
+        template<typename K>
+        using encoded_t = typename uint_of<sizeof(K)>::type;
+
+        // Order-preserving unsigned encoding of a key. Signed integers get their sign bit
+        // flipped. Negative floats get all bits flipped, the others only the sign bit. -0.0 is
+        // encoded as +0.0 so that the two stay in input order, and every NaN sorts last.
+        template<radix_key K>
+        inline encoded_t<K> encode(K k) {
+            typedef encoded_t<K> U;
+            constexpr U sign = U(U(1) << (8 * sizeof(U) - 1));
+
+            if constexpr (std::is_floating_point_v<K>) {
+                if (k != k) return U(~U(0));
+                if (k == K(0)) k = K(0);
+                U u = std::bit_cast<U>(k);
+                return (u & sign) ? U(~u) : U(u | sign);
+            }
+            else if constexpr (std::is_signed_v<K>) {
+                return U(U(k) ^ sign);
+            }
+            else {
+                return U(k);
+            }
+        }
+
+        template<class Iter, class Key>
+        using key_type = std::remove_cvref_t<std::invoke_result_t<Key&, typename std::iterator_traits<Iter>::value_type&> >;
+
+        template<class Src, class Key>
+        inline auto encoded_key(Src src, Key& key) {
+            return encode(std::invoke(key, *src));
+        }
+
+        template<class Iter, class Key>
+        inline void insertion_sort(Iter begin, Iter end, Key& key) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            if (begin == end) return;
+
+            for (Iter cur = begin + 1; cur != end; ++cur) {
+                auto k = encoded_key(cur, key);
+                Iter sift = cur;
+                if (k < encoded_key(sift - 1, key)) {
+                    T tmp = std::move(*cur);
+                    do {
+                        *sift = std::move(*(sift - 1));
+                    } while (--sift != begin && k < encoded_key(sift - 1, key));
+                    *sift = std::move(tmp);
+                }
+            }
+        }
+
+        // Stably moves the n elements at src to dst, ordered by the digit at shift. offsets holds
+        // the start of every bucket and is advanced.
+        template<unsigned Bits, class Src, class Dst, class Key>
+        inline void scatter(Src src, Dst dst, std::size_t n, unsigned shift, std::size_t* offsets, Key& key) {
+            constexpr std::size_t mask = (std::size_t(1) << Bits) - 1;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::size_t d = std::size_t(encoded_key(src + i, key) >> shift) & mask;
+                dst[offsets[d]++] = std::move(src[i]);
+            }
+        }
+
+        // Turns counts into bucket offsets.
+        inline void exclusive_sum(std::size_t* counts, std::size_t radix) {
+            std::size_t sum = 0;
+            for (std::size_t d = 0; d < radix; ++d) {
+                std::size_t c = counts[d];
+                counts[d] = sum;
+                sum += c;
+            }
+        }
+
+        // LSD passes on the low `bits` bits of the n elements at src, using dst as the other
+        // buffer. The histograms of all passes are counted first, and the passes whose digit is
+        // the same for every element are skipped. Returns true if the result is in dst.
+        template<unsigned Bits, class Src, class Dst, class Key>
+        inline bool lsd_sort(Src src, Dst dst, std::size_t n, unsigned bits, Key& key) {
+            constexpr std::size_t radix = std::size_t(1) << Bits;
+            constexpr std::size_t mask = radix - 1;
+            unsigned passes = (bits + Bits - 1) / Bits;
+
+            std::vector<std::size_t> counts(passes * radix);
+            for (std::size_t i = 0; i < n; ++i) {
+                auto u = encoded_key(src + i, key);
+                for (unsigned p = 0; p < passes; ++p) ++counts[p * radix + (std::size_t(u >> (p * Bits)) & mask)];
+            }
+
+            auto u0 = encoded_key(src, key);
+            bool in_dst = false;
+            for (unsigned p = 0; p < passes; ++p) {
+                std::size_t* count = counts.data() + p * radix;
+                if (count[std::size_t(u0 >> (p * Bits)) & mask] == n) continue;
+
+                exclusive_sum(count, radix);
+                if (in_dst) scatter<Bits>(dst, src, n, p * Bits, count, key);
+                else scatter<Bits>(src, dst, n, p * Bits, count, key);
+                in_dst = !in_dst;
+            }
+            return in_dst;
+        }
+
+        // Sorts the n elements at a by their low `bits` key bits, the higher bits being equal.
+        // The elements are currently at b if InBuffer, else at a; the other range is free.
+        // Ranges that do not fit in cache are split on their top 8 bits first, every piece is
+        // then sorted on its own part of a and b.
+        template<bool InBuffer, class Iter, class T, class Key>
+        void sort_range(Iter a, T* b, std::size_t n, unsigned bits, Key& key) {
+            if (n <= insertion_sort_threshold || bits == 0) {
+                if constexpr (InBuffer) std::move(b, b + n, a);
+                insertion_sort(a, a + n, key);
+                return;
+            }
+
+            if (n * sizeof(T) <= block_bytes) {
+                bool moved;
+                if (bits <= 16 && n >= (std::size_t(1) << 16)) {
+                    moved = InBuffer ? lsd_sort<16>(b, a, n, bits, key) : lsd_sort<16>(a, b, n, bits, key);
+                }
+                else if ((bits + 10) / 11 < (bits + 7) / 8 && n >= (std::size_t(1) << 12)) {
+                    moved = InBuffer ? lsd_sort<11>(b, a, n, bits, key) : lsd_sort<11>(a, b, n, bits, key);
+                }
+                else {
+                    moved = InBuffer ? lsd_sort<8>(b, a, n, bits, key) : lsd_sort<8>(a, b, n, bits, key);
+                }
+                if (InBuffer != moved) std::move(b, b + n, a);
+                return;
+            }
+
+            constexpr std::size_t radix = 256;
+            unsigned shift = bits > 8 ? bits - 8 : 0;
+            std::size_t counts[radix] = {};
+            for (std::size_t i = 0; i < n; ++i) {
+                if constexpr (InBuffer) ++counts[std::size_t(encoded_key(b + i, key) >> shift) & (radix - 1)];
+                else ++counts[std::size_t(encoded_key(a + i, key) >> shift) & (radix - 1)];
+            }
+
+            std::size_t first_key_digit;
+            if constexpr (InBuffer) first_key_digit = std::size_t(encoded_key(b, key) >> shift) & (radix - 1);
+            else first_key_digit = std::size_t(encoded_key(a, key) >> shift) & (radix - 1);
+            if (counts[first_key_digit] == n) {
+                sort_range<InBuffer>(a, b, n, shift, key);
+                return;
+            }
+
+            std::size_t starts[radix + 1];
+            exclusive_sum(counts, radix);
+            std::copy(counts, counts + radix, starts);
+            starts[radix] = n;
+            if constexpr (InBuffer) scatter<8>(b, a, n, shift, counts, key);
+            else scatter<8>(a, b, n, shift, counts, key);
+
+            for (std::size_t d = 0; d < radix; ++d) {
+                std::size_t size = starts[d + 1] - starts[d];
+                if (size > 0) sort_range<!InBuffer>(a + starts[d], b + starts[d], size, shift, key);
+            }
+        }
+    }
+
+    // Stably sorts [begin, end) by the arithmetic key std::invoke(key, element).
+    template<class Iter, class Key>
+    inline void radixsort(Iter begin, Iter end, Key key) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        typedef radix_detail::encoded_t<radix_detail::key_type<Iter, Key> > U;
+
+        std::size_t n = std::size_t(end - begin);
+        if (n <= radix_detail::insertion_sort_threshold) {
+            radix_detail::insertion_sort(begin, end, key);
+            return;
+        }
+
+        T* buffer = std::allocator<T>().allocate(n);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            try {
+                radix_detail::sort_range<false>(begin, buffer, n, 8 * sizeof(U), key);
+            }
+            catch (...) {
+                std::allocator<T>().deallocate(buffer, n);
+                throw;
+            }
+        }
+        else {
+            // The passes move-assign into the buffer, so it needs live elements.
+            try {
+                std::uninitialized_move(begin, end, buffer);
+            }
+            catch (...) {
+                std::allocator<T>().deallocate(buffer, n);
+                throw;
+            }
+            try {
+                radix_detail::sort_range<true>(begin, buffer, n, 8 * sizeof(U), key);
+            }
+            catch (...) {
+                std::destroy_n(buffer, n);
+                std::allocator<T>().deallocate(buffer, n);
+                throw;
+            }
+            std::destroy_n(buffer, n);
+        }
+        std::allocator<T>().deallocate(buffer, n);
+    }
+
+    template<class Iter>
+    inline void radixsort(Iter begin, Iter end) {
+        radixsort(begin, end, std::identity());
+    }
+}
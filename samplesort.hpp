@@ -0,0 +1,567 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// samplesort.hpp: In-place (parallel) super scalar samplesort.
+// Follows the design of IPS4o ("In-place Parallel Super Scalar Samplesort", Axtmann,
+// Witt, Ferizovic and Sanders, 2017). One step of the algorithm:
+//   1. draws a sample, sorts it and stores the splitters in an implicit search tree,
+//      classified without branches;
+//   2. every thread reads its stripe of the input and collects the elements in one
+//      buffer block per bucket, writing full blocks back into the stripe;
+//   3. the full blocks are permuted so that each bucket gets a contiguous run of blocks;
+//   4. the partial blocks at bucket boundaries and the buffers are written back.
+// Buckets are then sorted recursively, small ones with pdqsort. The extra memory is
+// O(threads * buckets * block size), independent of the input size.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pdqsort.hpp"
+#include "mayanpar.hpp"
+
+namespace MayanSort {
+    namespace samplesort_detail {
+        enum {
+            // Ranges below this size are sorted with pdqsort.
+            base_case_size = 1 << 12,
+
+            // Logarithm of the maximum number of buckets of a step (equal buckets excluded).
+            max_log_buckets = 8,
+
+            // Size of a distribution block in bytes.
+            block_bytes = 2048,
+
+            // Ranges below this size are not split between threads.
+            parallel_threshold = 1 << 16,
+
+            // Smallest stripe handed to one thread in a parallel step.
+            min_stripe = 1 << 14
+        };
+
+        template<class T>
+        constexpr std::ptrdiff_t block_size() {
+            return sizeof(T) >= block_bytes ? 1 : std::ptrdiff_t(block_bytes / sizeof(T));
+        }
+
+        // Returns floor(log2(n)), assumes n > 0.
+        template<class T>
+        inline int log2(T n) {
+            int log = 0;
+            while (n >>= 1) ++log;
+            return log;
+        }
+
+        // Maps an element to its bucket with a branchless descent of a complete binary search
+        // tree of splitters in Eytzinger layout. With equal buckets, elements equal to a splitter
+        // go to their own odd bucket, which needs no further sorting.
+        template<class T>
+        class Classifier {
+            std::vector<T> tree_;
+            std::vector<T> sorted_;
+            int log_buckets_ = 0;
+            std::size_t num_buckets_ = 0;
+            bool equal_buckets_ = false;
+
+            void build(std::size_t node, std::size_t lo, std::size_t hi) {
+                std::size_t mid = lo + (hi - lo) / 2;
+                tree_[node] = sorted_[mid];
+                if (2 * node < num_buckets_) {
+                    build(2 * node, lo, mid);
+                    build(2 * node + 1, mid + 1, hi);
+                }
+            }
+
+        public:
+            // splitters must be sorted and distinct.
+            void reset(std::vector<T>& splitters, bool equal_buckets) {
+                log_buckets_ = log2(splitters.size()) + 1;
+                num_buckets_ = std::size_t(1) << log_buckets_;
+                equal_buckets_ = equal_buckets;
+
+                sorted_.clear();
+                for (T& s : splitters) sorted_.push_back(std::move(s));
+                while (sorted_.size() < num_buckets_) sorted_.push_back(sorted_.back());
+
+                tree_.assign(num_buckets_, sorted_[0]);
+                build(1, 0, num_buckets_ - 1);
+            }
+
+            std::size_t buckets() const {
+                return equal_buckets_ ? 2 * num_buckets_ : num_buckets_;
+            }
+
+            bool is_equal_bucket(std::size_t b) const {
+                return equal_buckets_ && (b & 1) && b + 1 < buckets();
+            }
+
+            template<class Compare>
+            std::size_t classify(const T& x, Compare& comp) const {
+                std::size_t b = 1;
+                for (int l = 0; l < log_buckets_; ++l) b = 2 * b + comp(tree_[b], x);
+                b -= num_buckets_;
+                if (equal_buckets_) b = 2 * b + !comp(x, sorted_[b]);
+                return b;
+            }
+
+            // Classifies [first, last) four elements at a time to overlap the tree descents,
+            // calling yield(bucket, element) for every element.
+            template<class Iter, class Compare, class F>
+            void classify_batch(Iter first, Iter last, Compare& comp, F&& yield) const {
+                while (last - first >= 4) {
+                    std::size_t b0 = 1, b1 = 1, b2 = 1, b3 = 1;
+                    for (int l = 0; l < log_buckets_; ++l) {
+                        b0 = 2 * b0 + comp(tree_[b0], first[0]);
+                        b1 = 2 * b1 + comp(tree_[b1], first[1]);
+                        b2 = 2 * b2 + comp(tree_[b2], first[2]);
+                        b3 = 2 * b3 + comp(tree_[b3], first[3]);
+                    }
+                    b0 -= num_buckets_; b1 -= num_buckets_; b2 -= num_buckets_; b3 -= num_buckets_;
+                    if (equal_buckets_) {
+                        b0 = 2 * b0 + !comp(first[0], sorted_[b0]);
+                        b1 = 2 * b1 + !comp(first[1], sorted_[b1]);
+                        b2 = 2 * b2 + !comp(first[2], sorted_[b2]);
+                        b3 = 2 * b3 + !comp(first[3], sorted_[b3]);
+                    }
+                    yield(b0, first[0]);
+                    yield(b1, first[1]);
+                    yield(b2, first[2]);
+                    yield(b3, first[3]);
+                    first += 4;
+                }
+                for (; first != last; ++first) yield(classify(*first, comp), *first);
+            }
+        };
+
+        // Memory owned by one thread, reused between steps.
+        template<class T, class Compare>
+        struct LocalData {
+            std::vector<std::vector<T> > buffers;   // one partial block per bucket
+            std::vector<std::ptrdiff_t> counts;     // elements per bucket
+            std::vector<std::ptrdiff_t> blocks;     // full blocks per bucket
+            std::vector<T> swap[2];                 // blocks in flight during the permutation
+            std::ptrdiff_t stripe_begin = 0, stripe_end = 0, write_end = 0;
+            Compare comp;
+
+            explicit LocalData(const Compare& c) : comp(c) {}
+
+            void reset(std::size_t buckets) {
+                if (buffers.size() < buckets) buffers.resize(buckets);
+                for (std::size_t b = 0; b < buckets; ++b) buffers[b].clear();
+                counts.assign(buckets, 0);
+                blocks.assign(buckets, 0);
+            }
+        };
+
+        // Read and write pointers of a bucket during the block permutation, both counted in
+        // blocks from the start of the bucket. They share one word so that a thread taking a
+        // block to read and a thread taking a slot to write agree on the state of the bucket.
+        struct alignas(64) BucketPointers {
+            static constexpr std::uint64_t bias = std::uint64_t(1) << 31;
+
+            std::atomic<std::uint64_t> wr;
+            std::atomic<int> reading;
+
+            void set(std::ptrdiff_t w, std::ptrdiff_t r) {
+                wr.store((std::uint64_t(w) << 32) | (std::uint64_t(r) + bias), std::memory_order_relaxed);
+                reading.store(0, std::memory_order_relaxed);
+            }
+
+            static std::ptrdiff_t w_of(std::uint64_t v) { return std::ptrdiff_t(v >> 32); }
+            static std::ptrdiff_t r_of(std::uint64_t v) { return std::ptrdiff_t(v & 0xffffffffu) - std::ptrdiff_t(bias); }
+        };
+
+        template<class Iter, class Compare>
+        class Sorter {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            typedef std::ptrdiff_t diff_t;
+            typedef LocalData<T, Compare> Local;
+
+            static constexpr diff_t B = block_size<T>();
+
+            _parallel::TaskPool* pool_;
+            std::vector<Local>& locals_;
+            Compare comp_;
+            std::minstd_rand rng_;
+
+            Classifier<T> classifier_;
+            std::vector<BucketPointers> pointers_;
+            std::vector<diff_t> starts_;           // bucket boundaries, size buckets + 1
+            std::vector<diff_t> regions_;          // block aligned bucket regions, size buckets + 1
+            std::vector<diff_t> bucket_blocks_;    // full blocks per bucket
+            std::vector<std::vector<T> > saved_;   // elements of a bucket's last block past its end
+            std::vector<T> overflow_;              // block written to a slot that passes the array end
+            std::size_t overflow_bucket_ = 0;
+            bool overflow_used_ = false;
+
+            template<class F>
+            void run(std::size_t threads, F&& f) {
+                if (threads == 1) f(std::size_t(0));
+                else pool_->parallel_for(threads, f);
+            }
+
+            static void move_block(Iter from, Iter to) {
+                std::move(from, from + B, to);
+            }
+
+            // Draws the sample to the front of the range, sorts it and builds the classifier.
+            // Returns false if the splitters could not be chosen.
+            bool sample(Iter begin, diff_t n) {
+                int log_buckets = std::min<int>(max_log_buckets, log2(n / base_case_size) + 1);
+                diff_t num_buckets = diff_t(1) << log_buckets;
+                diff_t oversampling = std::max(1, log2(n) / 5);
+                diff_t sample_size = std::min(oversampling * num_buckets - 1, n / 2);
+
+                for (diff_t i = 0; i < sample_size; ++i) {
+                    diff_t j = i + diff_t(rng_() % std::uint64_t(n - i));
+                    std::iter_swap(begin + i, begin + j);
+                }
+                pdqsort(begin, begin + sample_size, comp_);
+
+                // Use equal buckets as soon as a splitter is repeated in the sample.
+                std::vector<T> splitters;
+                bool duplicates = false;
+                for (diff_t i = oversampling - 1; i < sample_size; i += oversampling) {
+                    const T& s = *(begin + i);
+                    if (i > 0 && !comp_(*(begin + (i - 1)), s)) duplicates = true;
+                    if (splitters.empty() || comp_(splitters.back(), s)) splitters.push_back(s);
+                }
+                if (splitters.empty()) return false;
+
+                classifier_.reset(splitters, duplicates);
+                return true;
+            }
+
+            // Phase 2: classifies the stripe of a thread into its buffers. Full buffers are written
+            // back to the beginning of the stripe, which ends up as [full blocks][free space].
+            void classify_stripe(Iter begin, Local& local) {
+                std::size_t buckets = classifier_.buckets();
+                local.reset(buckets);
+                Iter write = begin + local.stripe_begin;
+                classifier_.classify_batch(begin + local.stripe_begin, begin + local.stripe_end, local.comp,
+                    [&](std::size_t b, T& x) {
+                        std::vector<T>& buffer = local.buffers[b];
+                        if (diff_t(buffer.size()) == B) {
+                            std::move(buffer.begin(), buffer.end(), write);
+                            write += B;
+                            buffer.clear();
+                            ++local.blocks[b];
+                        }
+                        buffer.push_back(std::move(x));
+                        ++local.counts[b];
+                    });
+                local.write_end = write - begin;
+            }
+
+            // Phase 3a: moves the full blocks of each bucket region to its front and sets the
+            // pointers of the permutation.
+            void prepare_regions(Iter begin, std::size_t first, std::size_t last, std::size_t threads) {
+                for (std::size_t b = first; b < last; ++b) {
+                    diff_t lo = regions_[b] / B, hi = regions_[b + 1] / B;
+                    std::size_t t = 0;
+                    auto full = [&](diff_t block) {
+                        while (t + 1 < threads && locals_[t + 1].stripe_begin <= block * B) ++t;
+                        while (t > 0 && locals_[t].stripe_begin > block * B) --t;
+                        return block * B < locals_[t].write_end;
+                    };
+
+                    diff_t l = lo, h = hi - 1;
+                    while (l <= h) {
+                        if (full(l)) ++l;
+                        else if (!full(h)) --h;
+                        else {
+                            move_block(begin + h * B, begin + l * B);
+                            ++l;
+                            --h;
+                        }
+                    }
+                    pointers_[b].set(0, l - lo);
+                }
+            }
+
+            // Phase 3b: every block is carried to the next free slot of its bucket. A slot that
+            // still holds an unread block is swapped with the carried one.
+            void permute_blocks(Iter begin, diff_t n, Local& local, std::size_t first_bucket) {
+                std::size_t buckets = classifier_.buckets();
+                for (std::vector<T>& s : local.swap) s.reserve(B);
+
+                for (std::size_t i = 0; i < buckets; ++i) {
+                    std::size_t b = (first_bucket + i) % buckets;
+                    while (true) {
+                        BucketPointers& src = pointers_[b];
+                        src.reading.fetch_add(1, std::memory_order_acq_rel);
+                        std::uint64_t v = src.wr.fetch_sub(1, std::memory_order_acq_rel);
+                        diff_t r = BucketPointers::r_of(v);
+                        if (r <= BucketPointers::w_of(v)) {
+                            src.reading.fetch_sub(1, std::memory_order_acq_rel);
+                            break;
+                        }
+                        Iter block = begin + (regions_[b] + (r - 1) * B);
+                        int cur = 0;
+                        local.swap[cur].assign(std::make_move_iterator(block), std::make_move_iterator(block + B));
+                        src.reading.fetch_sub(1, std::memory_order_acq_rel);
+
+                        while (true) {
+                            std::size_t d = classifier_.classify(local.swap[cur][0], local.comp);
+                            BucketPointers& dst = pointers_[d];
+                            std::uint64_t u = dst.wr.fetch_add(std::uint64_t(1) << 32, std::memory_order_acq_rel);
+                            diff_t w = BucketPointers::w_of(u);
+                            diff_t slot = regions_[d] + w * B;
+
+                            if (w < BucketPointers::r_of(u)) {
+                                Iter target = begin + slot;
+                                local.swap[1 - cur].assign(std::make_move_iterator(target),
+                                                           std::make_move_iterator(target + B));
+                                std::move(local.swap[cur].begin(), local.swap[cur].end(), target);
+                                cur = 1 - cur;
+                                continue;
+                            }
+
+                            // The slot is free, but a reader may still be copying the block it held.
+                            while (dst.reading.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+                            if (slot + B > n) {
+                                overflow_ = std::move(local.swap[cur]);
+                                overflow_bucket_ = d;
+                                overflow_used_ = true;
+                            }
+                            else {
+                                std::move(local.swap[cur].begin(), local.swap[cur].end(), begin + slot);
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // Phase 4a: takes out the elements of the last block of each bucket that lie past the
+            // end of the bucket, they belong to the space of the following buckets.
+            void save_margins(Iter begin, std::size_t first, std::size_t last) {
+                for (std::size_t b = first; b < last; ++b) {
+                    saved_[b].clear();
+                    diff_t blocks_end = regions_[b] + bucket_blocks_[b] * B;
+                    if (overflow_used_ && b == overflow_bucket_) {
+                        saved_[b] = std::move(overflow_);
+                    }
+                    else if (bucket_blocks_[b] > 0 && blocks_end > starts_[b + 1]) {
+                        saved_[b].assign(std::make_move_iterator(begin + starts_[b + 1]),
+                                         std::make_move_iterator(begin + blocks_end));
+                    }
+                }
+            }
+
+            // Phase 4b: fills the free space of each bucket with its saved margin and the content
+            // of the buffers of all threads.
+            void write_margins(Iter begin, std::size_t first, std::size_t last, std::size_t threads) {
+                for (std::size_t b = first; b < last; ++b) {
+                    diff_t start = starts_[b], end = starts_[b + 1];
+                    diff_t blocks_end = regions_[b] + bucket_blocks_[b] * B;
+                    if (overflow_used_ && b == overflow_bucket_) blocks_end -= B;
+                    blocks_end = std::min(blocks_end, end);
+
+                    // Free space is [start, regions_[b]) and [blocks_end, end), clipped to the bucket.
+                    diff_t head_end = std::min(regions_[b], end);
+                    diff_t pos = start;
+                    auto put = [&](T& x) {
+                        if (pos == head_end) pos = std::max(blocks_end, head_end);
+                        *(begin + pos) = std::move(x);
+                        ++pos;
+                    };
+                    for (T& x : saved_[b]) put(x);
+                    for (std::size_t t = 0; t < threads; ++t) {
+                        for (T& x : locals_[t].buffers[b]) put(x);
+                    }
+                }
+            }
+
+            // One partitioning step of [begin, begin + n) on `threads` threads. Returns false if
+            // no splitter could be chosen, starts_ holds the bucket boundaries otherwise.
+            bool partition(Iter begin, diff_t n, std::size_t threads) {
+                if (!sample(begin, n)) return false;
+                std::size_t buckets = classifier_.buckets();
+
+                diff_t full_blocks = n / B;
+                for (std::size_t t = 0; t < threads; ++t) {
+                    locals_[t].stripe_begin = full_blocks * diff_t(t) / diff_t(threads) * B;
+                    locals_[t].stripe_end = t + 1 == threads ? n : full_blocks * diff_t(t + 1) / diff_t(threads) * B;
+                }
+                run(threads, [&](std::size_t t) { classify_stripe(begin, locals_[t]); });
+
+                starts_.assign(buckets + 1, 0);
+                regions_.assign(buckets + 1, 0);
+                bucket_blocks_.assign(buckets, 0);
+                for (std::size_t b = 0; b < buckets; ++b) {
+                    diff_t size = 0;
+                    for (std::size_t t = 0; t < threads; ++t) {
+                        size += locals_[t].counts[b];
+                        bucket_blocks_[b] += locals_[t].blocks[b];
+                    }
+                    starts_[b + 1] = starts_[b] + size;
+                    regions_[b + 1] = (starts_[b + 1] + B - 1) / B * B;
+                }
+
+                std::vector<BucketPointers> pointers(buckets);
+                pointers_.swap(pointers);
+                if (saved_.size() < buckets) saved_.resize(buckets);
+                overflow_used_ = false;
+
+                auto first_bucket = [&](std::size_t t) { return buckets * t / threads; };
+                run(threads, [&](std::size_t t) {
+                    prepare_regions(begin, first_bucket(t), first_bucket(t + 1), threads);
+                });
+                run(threads, [&](std::size_t t) { permute_blocks(begin, n, locals_[t], first_bucket(t)); });
+                run(threads, [&](std::size_t t) { save_margins(begin, first_bucket(t), first_bucket(t + 1)); });
+                run(threads, [&](std::size_t t) {
+                    write_margins(begin, first_bucket(t), first_bucket(t + 1), threads);
+                });
+                return true;
+            }
+
+        public:
+            Sorter(_parallel::TaskPool* pool, std::vector<Local>& locals, const Compare& comp, diff_t n)
+                : pool_(pool), locals_(locals), comp_(comp), rng_(std::uint32_t(n) | 1) {
+            }
+
+            // Sorts [begin, end) on one thread.
+            void sequential(Iter begin, Iter end, int depth) {
+                diff_t n = end - begin;
+                if (n <= base_case_size || depth <= 0 || !partition(begin, n, 1)) {
+                    pdqsort(begin, end, comp_);
+                    return;
+                }
+
+                // The recursion reuses the members, keep what is needed of this step.
+                std::vector<std::pair<diff_t, diff_t> > todo;
+                for (std::size_t b = 0; b + 1 < starts_.size(); ++b) {
+                    if (starts_[b + 1] - starts_[b] > 1 && !classifier_.is_equal_bucket(b)) {
+                        todo.emplace_back(starts_[b], starts_[b + 1]);
+                    }
+                }
+                for (const std::pair<diff_t, diff_t>& r : todo) {
+                    sequential(begin + r.first, begin + r.second, depth - 1);
+                }
+            }
+
+            // Splits [begin, end) with all threads, then sorts the buckets as independent tasks.
+            // The memory of the step is freed before the tasks are spawned: a thread waiting for
+            // them runs other tasks on its stack, so only the step or sequential sort a thread is
+            // working on holds buffers, O(threads * buckets * block size) for the whole sort.
+            static void parallel(_parallel::TaskPool& pool, Iter begin, Iter end, const Compare& comp, int depth) {
+                diff_t n = end - begin;
+                std::size_t threads = std::min<std::size_t>(pool.size(), std::size_t(n / min_stripe));
+
+                if (n < parallel_threshold || threads <= 1 || depth <= 0) {
+                    std::vector<Local> locals(1, Local(comp));
+                    Sorter(nullptr, locals, comp, n).sequential(begin, end, depth);
+                    return;
+                }
+
+                std::vector<std::pair<diff_t, diff_t> > todo;
+                {
+                    std::vector<Local> locals(threads, Local(comp));
+                    Sorter sorter(&pool, locals, comp, n);
+                    if (!sorter.partition(begin, n, threads)) {
+                        sorter.sequential(begin, end, depth);
+                        return;
+                    }
+                    for (std::size_t b = 0; b + 1 < sorter.starts_.size(); ++b) {
+                        if (sorter.starts_[b + 1] - sorter.starts_[b] > 1 && !sorter.classifier_.is_equal_bucket(b)) {
+                            todo.emplace_back(sorter.starts_[b], sorter.starts_[b + 1]);
+                        }
+                    }
+                }
+
+                _parallel::TaskGroup group;
+                for (const std::pair<diff_t, diff_t>& r : todo) {
+                    Iter first = begin + r.first, last = begin + r.second;
+                    pool.spawn(group, [&pool, first, last, &comp, depth]() {
+                        parallel(pool, first, last, comp, depth - 1);
+                    });
+                }
+                pool.wait(group);
+            }
+        };
+    }
+
+    // Sorts [begin, end) with the in-place samplesort on one thread.
+    template<class Iter, class Compare>
+    inline void samplesort(Iter begin, Iter end, Compare comp) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        typedef samplesort_detail::LocalData<T, Compare> Local;
+
+        if constexpr (!std::is_copy_constructible<T>::value) {
+            // Splitters are copies of sampled elements.
+            pdqsort(begin, end, comp);
+        }
+        else {
+            std::vector<Local> locals(1, Local(comp));
+            samplesort_detail::Sorter<Iter, Compare> sorter(nullptr, locals, comp, end - begin);
+            sorter.sequential(begin, end, 2 * samplesort_detail::log2(std::max<std::ptrdiff_t>(end - begin, 1)));
+        }
+    }
+
+    template<class Iter>
+    inline void samplesort(Iter begin, Iter end) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        samplesort(begin, end, std::less<T>());
+    }
+
+    // Sorts [begin, end) with the in-place samplesort on `threads` threads of the shared pool
+    // (0 means all).
+    template<class Iter, class Compare>
+    inline void parallel_samplesort(Iter begin, Iter end, Compare comp, unsigned threads = 0) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+
+        if (threads == 0) threads = _parallel::default_threads();
+        if (threads == 1 || end - begin < samplesort_detail::parallel_threshold
+            || !std::is_copy_constructible<T>::value) {
+            samplesort(begin, end, comp);
+            return;
+        }
+
+        if constexpr (std::is_copy_constructible<T>::value) {
+            _parallel::TaskPool pool(threads);
+            _parallel::TaskGroup group;
+            pool.spawn(group, [&]() {
+                samplesort_detail::Sorter<Iter, Compare>::parallel(
+                    pool, begin, end, comp, 2 * samplesort_detail::log2(end - begin));
+            });
+            pool.wait(group);
+        }
+    }
+
+    template<class Iter>
+    inline void parallel_samplesort(Iter begin, Iter end) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        parallel_samplesort(begin, end, std::less<T>());
+    }
+}
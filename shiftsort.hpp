@@ -32,27 +32,31 @@
 #pragma once
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "mayanmem.hpp"
+
 namespace MayanSort {
     namespace _shiftsort {
-        template <class RandomAccessIterator, class Size, class Compare>
+        //the shorter list is copied to temp, which is shared by all the merges of a sort
+        template <class RandomAccessIterator, class Size, class Compare, class Type, class Alloc>
         void _merge(
             RandomAccessIterator array, 
             Size first_index, Size second_index, Size third_index, 
-            Compare comp
+            Compare comp, _mem::buffer<Type, Alloc>& temp
         )
         {
 
-            using Type = typename std::iterator_traits<RandomAccessIterator>::value_type;
             //if first_list>second_list, have second list be the list that gets merged into the first list
             if (second_index - first_index > third_index - second_index)
             {
-                std::vector<Type> temp_2nd(third_index - second_index);
+                Type* temp_2nd = temp.prime(array + second_index, third_index - second_index);
                 Size counter = 0;
                 for (Size y = second_index; y < third_index; y++)
                 {
-                    temp_2nd[counter] = array[y];
+                    temp_2nd[counter] = std::move(array[y]);
                     counter++;
                 }
 
@@ -64,13 +68,13 @@ namespace MayanSort {
                     //shift if left is greater than right
                     if (left >= first_index && comp(temp_2nd[second_counter - 1], array[left]))
                     {
-                        array[left + second_counter] = array[left];
+                        array[left + second_counter] = std::move(array[left]);
                         left--;
                     }
                     //add from 2nd if greater than left
                     else
                     {
-                        array[left + second_counter] = temp_2nd[second_counter - 1];
+                        array[left + second_counter] = std::move(temp_2nd[second_counter - 1]);
                         second_counter--;
                     }
                 }
@@ -79,11 +83,11 @@ namespace MayanSort {
             }
             else
             {
-                std::vector<Type> temp_1st(third_index - second_index);
+                Type* temp_1st = temp.prime(array + first_index, second_index - first_index);
                 Size counter = 0;
                 for (Size y = first_index; y < second_index; y++)
                 {
-                    temp_1st[counter] = array[y];
+                    temp_1st[counter] = std::move(array[y]);
                     counter++;
                 }
 
@@ -97,13 +101,13 @@ namespace MayanSort {
                     //shift if left is greater than right
                     if (right < third_index && comp(array[right], temp_1st[first_counter]))
                     {
-                        array[right - temp_length] = array[right];
+                        array[right - temp_length] = std::move(array[right]);
                         right++;
                     }
                     //add from 2nd if greater than left
                     else
                     {
-                        array[right - temp_length] = temp_1st[first_counter];
+                        array[right - temp_length] = std::move(temp_1st[first_counter]);
                         first_counter++;
                         temp_length--;
                     }
@@ -115,13 +119,14 @@ namespace MayanSort {
 
         }
 
-        template <class RandomAccessIterator, class Size, class Compare>
-        void _split(RandomAccessIterator array, Size* zero_indices, Size i, Size j, Compare comp)
+        template <class RandomAccessIterator, class Size, class Compare, class Type, class Alloc>
+        void _split(RandomAccessIterator array, Size* zero_indices, Size i, Size j, Compare comp,
+            _mem::buffer<Type, Alloc>& temp)
         {
             //if have exactly 3 indices, then merge the 2 lists
             if ((j - i) == 2)
             {
-                _merge(array, zero_indices[j], zero_indices[j - 1], zero_indices[i], comp);
+                _merge(array, zero_indices[j], zero_indices[j - 1], zero_indices[i], comp, temp);
                 return;
             }
             //too few indices to know the bounds of the sublists in array
@@ -133,23 +138,25 @@ namespace MayanSort {
             Size new_i = new_j + 1;
 
             //continues splitting first half
-            _split(array, zero_indices, i, new_j, comp);
+            _split(array, zero_indices, i, new_j, comp, temp);
             //continues splitting second half
-            _split(array, zero_indices, new_i, j, comp);
+            _split(array, zero_indices, new_i, j, comp, temp);
 
             //merges first half
-            _merge(array, zero_indices[new_i], zero_indices[new_j], zero_indices[i], comp);
+            _merge(array, zero_indices[new_i], zero_indices[new_j], zero_indices[i], comp, temp);
             //merges second half
-            _merge(array, zero_indices[j], zero_indices[new_i], zero_indices[i], comp);
+            _merge(array, zero_indices[j], zero_indices[new_i], zero_indices[i], comp, temp);
         }
 
-        template <class RandomAccessIterator, class Size, class Compare>
-        void _shiftsort_loop(RandomAccessIterator array, Size size, Compare comp)
+        template <class RandomAccessIterator, class Size, class Compare, class Alloc>
+        void _shiftsort_loop(RandomAccessIterator array, Size size, Compare comp, const Alloc& alloc)
         {
 
+            using Type = typename std::iterator_traits<RandomAccessIterator>::value_type;
             Size temp = size / 2 + 2;
             //list of indices denoting the start of sorted sublists in array
-            Size* zero_indices = new Size[temp];
+            _mem::buffer<Size, Alloc> zero_buffer(temp, alloc);
+            Size* zero_indices = zero_buffer.data();
             zero_indices[0] = size;
 
             Size end_tracker = 1;
@@ -193,15 +200,17 @@ namespace MayanSort {
             zero_indices[end_tracker] = 0;
 
             //runs divide and conquer algorithm on the derivative index
-            _split(array, zero_indices, (Size)0, end_tracker, comp);
-
-            delete[] zero_indices;
+            _mem::buffer<Type, Alloc> merge_buffer(alloc);
+            _split(array, zero_indices, (Size)0, end_tracker, comp, merge_buffer);
         }
 
 
-        template <class RandomAccessIterator, class Compare>
-        void shiftsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
-            _shiftsort_loop(first, std::distance(first, last), comp);
+        //the buffers are taken from alloc, rebound to the types they hold (see mayanmem.hpp)
+        template <class RandomAccessIterator, class Compare,
+            class Alloc = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+        void shiftsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+            const Alloc& alloc = Alloc()) {
+            _shiftsort_loop(first, std::distance(first, last), comp, alloc);
         }
     }
 }
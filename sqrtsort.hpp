@@ -36,7 +36,9 @@
 /*********************************************************/
 
 #include "mayandef.hpp"
+#include "mayanmem.hpp"
 #include<iterator>
+#include<memory>
 #include<type_traits>
 
 namespace MayanSort{
@@ -52,14 +54,14 @@ namespace MayanSort{
     			*b++ = c;
     		}
     
-    		template<typename It>
-    		inline void sqrtsort_swapN(It a, It b, int n) {
+    		template<typename It, typename Size>
+    		inline void sqrtsort_swapN(It a, It b, Size n) {
     			while (n--) sqrtsort_swap1(a++, b++);
     		}
     
-    		template<typename It, typename Comp>
-    		static void sqrtsort_MergeRight(It arr, int L1, int L2, int M, Comp comp) {
-    			int p0 = L1 + L2 + M - 1, p2 = L1 + L2 - 1, p1 = L1 - 1;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_MergeRight(It arr, Size L1, Size L2, Size M, Comp comp) {
+    			Size p0 = L1 + L2 + M - 1, p2 = L1 + L2 - 1, p1 = L1 - 1;
     
     			while (p1 >= 0) {
     				if (p2 < L1 || comp(arr + p1, arr + p2)>0) {
@@ -73,9 +75,9 @@ namespace MayanSort{
     		}
     
     		// arr[M..-1] - free, arr[0,L1-1]++arr[L1,L1+L2-1] -> arr[M,M+L1+L2-1]
-    		template<typename It, typename Comp>
-    		static void sqrtsort_MergeLeftWithXBuf(It arr, int L1, int L2, int M, Comp comp) {
-    			int p0 = 0, p1 = L1;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_MergeLeftWithXBuf(It arr, Size L1, Size L2, Size M, Comp comp) {
+    			Size p0 = 0, p1 = L1;
     			L2 += L1;
     			while (p1 < L2) {
     				if (p0 == L1 || comp(arr + p0, arr + p1) > 0) arr[M++] = arr[p1++];
@@ -85,9 +87,9 @@ namespace MayanSort{
     		}
     
     		// arr[0,L1-1] ++ arr2[0,L2-1] -> arr[-L1,L2-1],  arr2 is "before" arr1
-    		template<typename It, typename Comp>
-    		static void sqrtsort_MergeDown(It arr, It arr2, int L1, int L2, Comp comp) {
-    			int p0 = 0, p1 = 0, M = -L2;
+    		template<typename It, typename Buffer, typename Size, typename Comp>
+    		static void sqrtsort_MergeDown(It arr, Buffer arr2, Size L1, Size L2, Comp comp) {
+    			Size p0 = 0, p1 = 0, M = -L2;
     
     			while (p1 < L2) {
     				if (p0 == L1 || comp(arr + p0, arr2 + p1) >= 0) arr[M++] = arr2[p1++];
@@ -96,10 +98,10 @@ namespace MayanSort{
     			if (M != p0) while (p0 < L1) arr[M++] = arr[p0++];
     		}
     
-    		template<typename It, typename Comp>
-    		static void sqrtsort_SmartMergeWithXBuf(It arr, int* alen1, int* atype, int len2, int lkeys, Comp comp) {
-    			int p0 = -lkeys, p1 = 0, p2 = *alen1, q1 = p2, q2 = p2 + len2;
-    			int ftype = 1 - *atype;  // 1 if inverted
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_SmartMergeWithXBuf(It arr, Size* alen1, Size* atype, Size len2, Size lkeys, Comp comp) {
+    			Size p0 = -lkeys, p1 = 0, p2 = *alen1, q1 = p2, q2 = p2 + len2;
+    			Size ftype = 1 - *atype;  // 1 if inverted
     			while (p1 < q1 && p2 < q2) {
     				if (comp(arr + p1, arr + p2) - ftype < 0) arr[p0++] = arr[p1++];
     				else arr[p0++] = arr[p2++];
@@ -119,9 +121,9 @@ namespace MayanSort{
     		// keys - arrays of keys, in same order as blocks. key<midkey means stream A
     		// nblock2 are regular blocks from stream A. llast is length of last (irregular) block from stream B, that should go before nblock2 blocks.
     		// llast=0 requires nblock2=0 (no irregular blocks). llast>0, nblock2=0 is possible.
-    		template<typename It, typename Comp>
-    		static void sqrtsort_MergeBuffersLeftWithXBuf(int* keys, int midkey, It arr, int nblock, int lblock, int nblock2, int llast, Comp comp) {
-    			int l, prest, lrest, frest, pidx, cidx, fnext, plast;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_MergeBuffersLeftWithXBuf(Size* keys, Size midkey, It arr, Size nblock, Size lblock, Size nblock2, Size llast, Comp comp) {
+    			Size l, prest, lrest, frest, pidx, cidx, fnext, plast;
     
     			if (nblock == 0) {
     				l = nblock2 * lblock;
@@ -166,9 +168,9 @@ namespace MayanSort{
     		// build blocks of length K
     		// input: [-K,-1] elements are buffer
     		// output: first K elements are buffer, blocks 2*K and last subblock sorted
-    		template<typename It, typename Comp>
-    		static void sqrtsort_BuildBlocks(It arr, int L, int K, Comp comp) {
-    			int m, u, h, p0, p1, rest, restk, p;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_BuildBlocks(It arr, Size L, Size K, Comp comp) {
+    			Size m, u, h, p0, p1, rest, restk, p;
     			for (m = 1; m < L; m += 2) {
     				u = 0;
     				if (comp(arr + (m - 1), arr + m) > 0) u = 1;
@@ -203,9 +205,9 @@ namespace MayanSort{
     			}
     		}
     
-    		template<typename It, typename Comp>
-    		static void sqrtsort_SortIns(It arr, int len, Comp comp) {
-    			int i, j;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_SortIns(It arr, Size len, Comp comp) {
+    			Size i, j;
     			for (i = 1; i < len; i++) {
     				for (j = i - 1; j >= 0 && comp(arr + (j + 1), arr + j) < 0; j--) sqrtsort_swap1(arr + j, arr + (j + 1));
     			}
@@ -213,9 +215,9 @@ namespace MayanSort{
     
     		// keys are on the left of arr. Blocks of length LL combined. We'll combine them in pairs
     		// LL and nkeys are powers of 2. (2*LL/lblock) keys are guarantied
-    		template<typename It, typename Comp>
-    		static void sqrtsort_CombineBlocks(It arr, int len, int LL, int lblock, int* tags, Comp comp) {
-    			int M, nkeys, b, NBlk, midkey, lrest, u, i, p, v, kc, nbl2, llast;
+    		template<typename It, typename Size, typename Comp>
+    		static void sqrtsort_CombineBlocks(It arr, Size len, Size LL, Size lblock, Size* tags, Comp comp) {
+    			Size M, nkeys, b, NBlk, midkey, lrest, u, i, p, v, kc, nbl2, llast;
     			It arr1;
     
     			M = len / (2 * LL);
@@ -254,9 +256,9 @@ namespace MayanSort{
     			for (p = len; --p >= 0;) arr[p] = arr[p - lblock];
     		}
     
-    		template<typename It, typename Buffer, typename Comp>
-    		void sqrtsort_commonSort(It arr, int Len, Buffer extbuf, int* Tags, Comp comp) {
-    			int lblock, cbuf;
+    		template<typename It, typename Size, typename Buffer, typename Comp>
+    		void sqrtsort_commonSort(It arr, Size Len, Buffer extbuf, Size* Tags, Comp comp) {
+    			Size lblock, cbuf;
     
     			if (Len < 16) {
     				sqrtsort_SortIns(arr, Len, comp);
@@ -277,22 +279,19 @@ namespace MayanSort{
     			sqrtsort_MergeDown(arr + lblock, extbuf, Len - lblock, lblock, comp);
     		}
     
-    		template<typename It, typename Comp>
-    		void SqrtSort(It arr, int Len, Comp comp) {
-    			int L = 1;
-    			iter_value<It>* ExtBuf;
-    			int* Tags;
+    		template<typename It, typename Size, typename Comp, typename Alloc>
+    		void SqrtSort(It arr, Size Len, Comp comp, const Alloc& alloc) {
+    			// L is at least 1, so priming the buffer needs an element to copy.
+    			if (Len < 2) return;
+    			Size L = 1;
     
     			while (L * L < Len) L *= 2;
-    			int NK = (Len - 1) / L + 2;
-    			ExtBuf = new iter_value<It>[L];
-    			if (ExtBuf == NULL) return; // fail
-    			Tags = new int[NK];
-    			if (Tags == NULL) return;
+    			Size NK = (Len - 1) / L + 2;
+    			_mem::buffer<iter_value<It>, Alloc> ExtBuf(alloc);
+    			_mem::buffer<Size, Alloc> Tags(NK, alloc);
     
-    			sqrtsort_commonSort(arr, Len, ExtBuf, Tags, comp);
-    			delete[]ExtBuf;
-    			delete[]Tags;
+    			// The buffer is assigned to, so its slots are constructed from the first elements.
+    			sqrtsort_commonSort(arr, Len, ExtBuf.prime(arr, L), Tags.data(), comp);
     		}
     	}
     
@@ -305,7 +304,7 @@ namespace MayanSort{
     		{}
     
     		template<typename T, typename U>
-    		int operator()(T* lhs, U* rhs)
+    		int operator()(T lhs, U rhs)
     		{
     			if (compare(*lhs, *rhs)) {
     				return -1;
@@ -318,9 +317,12 @@ namespace MayanSort{
     	};
     
     
-    	template<typename RandomAccessIterator, typename Compare>
-    	void sqrtsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
-    		_internal::SqrtSort(first, (int)std::distance(first, last), comperator<Compare>(std::move(comp)));
+    	// The buffers are taken from alloc, rebound to the types they hold (see mayanmem.hpp).
+    	template<typename RandomAccessIterator, typename Compare,
+    		typename Alloc = std::allocator<_internal::iter_value<RandomAccessIterator>>>
+    	void sqrtsort(RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+    		const Alloc& alloc = Alloc()) {
+    		_internal::SqrtSort(first, std::distance(first, last), comperator<Compare>(std::move(comp)), alloc);
     	}
     
     	template<typename RandomAccessIterator>
@@ -0,0 +1,221 @@
+// MayanSort - many sort algorithms implementation in C++ 20.
+//
+// MIT License:
+// Copyright (c) 2023 The pysoft group.
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this softwareand associated documentation files(the
+//    "Software"), to deal in the Software without restriction, including
+//    without limitation the rights to use, copy, modify, merge, publish,
+//    distribute, sublicense, and /or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so, subject to
+//    the following conditions :
+//
+// The above copyright noticeand this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// string_sort.hpp: Multikey quicksort for strings, with character caching.
+// After "Engineering Radix Sort for Strings" and "Cache-efficient string sorting using
+// copying" (T. Rantala / R. Sinha et al.): the strings are sorted as an array of small items
+// that hold the next 8 characters of the string, read as one big-endian integer. Most
+// comparisons are then done on the items alone, and a common prefix is only ever read once.
+// The longest common prefixes of neighbouring strings can be returned as well.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace MayanSort {
+    namespace string_sort_detail {
+        enum {
+            // Groups up to this size are insertion sorted.
+            insertion_sort_threshold = 24
+        };
+
+        struct Item {
+            std::uint64_t cache; // Characters [depth, depth + 8) of the string, 0 past the end.
+            const char* str;
+            std::size_t len;
+            std::size_t idx;     // Position in the input range.
+        };
+
+        inline std::uint64_t load_chars(const char* s, std::size_t avail) {
+            std::uint64_t v = 0;
+            if (avail >= 8) {
+                std::memcpy(&v, s, 8);
+                if constexpr (std::endian::native == std::endian::little) {
+#if defined(__GNUC__) || defined(__clang__)
+                    v = __builtin_bswap64(v);
+#else
+                    std::uint64_t r = 0;
+                    for (int i = 0; i < 8; ++i, v >>= 8) r = (r << 8) | (v & 0xff);
+                    v = r;
+#endif
+                }
+                return v;
+            }
+            for (std::size_t i = 0; i < avail; ++i) {
+                v |= std::uint64_t(static_cast<unsigned char>(s[i])) << (56 - 8 * i);
+            }
+            return v;
+        }
+
+        inline void fill_cache(Item* a, std::size_t n, std::size_t depth) {
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i].cache = a[i].len > depth ? load_chars(a[i].str + depth, a[i].len - depth) : 0;
+            }
+        }
+
+        // Whether the string ends within the cached characters.
+        inline bool ended(const Item& a, std::size_t depth) {
+            return a.len <= depth + 8;
+        }
+
+        // Three-way comparison of two strings equal before depth.
+        inline int compare(const Item& a, const Item& b, std::size_t depth) {
+            if (a.cache != b.cache) return a.cache < b.cache ? -1 : 1;
+            if (ended(a, depth) || ended(b, depth)) return a.len < b.len ? -1 : a.len > b.len;
+
+            std::size_t from = depth + 8;
+            std::size_t common = std::min(a.len, b.len) - from;
+            int c = std::memcmp(a.str + from, b.str + from, common);
+            if (c != 0) return c;
+            return a.len < b.len ? -1 : a.len > b.len;
+        }
+
+        inline void insertion_sort(Item* a, std::size_t n, std::size_t depth) {
+            for (std::size_t i = 1; i < n; ++i) {
+                Item tmp = a[i];
+                std::size_t j = i;
+                for (; j > 0 && compare(tmp, a[j - 1], depth) < 0; --j) a[j] = a[j - 1];
+                a[j] = tmp;
+            }
+        }
+
+        inline std::uint64_t median3(std::uint64_t a, std::uint64_t b, std::uint64_t c) {
+            if (a < b) return b < c ? b : (a < c ? c : a);
+            return a < c ? a : (b < c ? c : b);
+        }
+
+        // Sorts the n items at a, whose strings are equal before depth and whose caches hold the
+        // characters at depth. Ternary split on the caches: the smaller and larger parts keep
+        // their depth, the equal part moves 8 characters further. The largest part is handled
+        // by the loop, so the recursion is O(log n) deep.
+        inline void mkqs(Item* a, std::size_t n, std::size_t depth) {
+            while (n > insertion_sort_threshold) {
+                std::uint64_t pivot = median3(a[0].cache, a[n / 2].cache, a[n - 1].cache);
+                if (n > 1024) {
+                    std::size_t s = n / 8;
+                    pivot = median3(median3(a[0].cache, a[s].cache, a[2 * s].cache),
+                                    median3(a[3 * s].cache, a[4 * s].cache, a[5 * s].cache),
+                                    median3(a[6 * s].cache, a[7 * s].cache, a[n - 1].cache));
+                }
+
+                // Dijkstra partition: [0, lt) < pivot, [lt, i) == pivot, (gt, n) > pivot.
+                std::size_t lt = 0, i = 0, gt = n;
+                while (i < gt) {
+                    std::uint64_t c = a[i].cache;
+                    if (c < pivot) std::swap(a[lt++], a[i++]);
+                    else if (c > pivot) std::swap(a[i], a[--gt]);
+                    else ++i;
+                }
+
+                // Among the equal ones, the strings that end here are only ordered by length and
+                // come first, the others go on with the next characters.
+                Item* eq = a + lt;
+                std::size_t eq_n = gt - lt;
+                Item* done_end = std::partition(eq, eq + eq_n, [depth](const Item& x) { return ended(x, depth); });
+                std::sort(eq, done_end, [](const Item& x, const Item& y) { return x.len < y.len; });
+                Item* more = done_end;
+                std::size_t more_n = std::size_t(eq + eq_n - more);
+                fill_cache(more, more_n, depth + 8);
+
+                struct Part { Item* a; std::size_t n; std::size_t depth; } parts[3] = {
+                    { a, lt, depth }, { more, more_n, depth + 8 }, { a + gt, n - gt, depth }
+                };
+                std::size_t largest = 0;
+                for (std::size_t p = 1; p < 3; ++p) {
+                    if (parts[p].n > parts[largest].n) largest = p;
+                }
+                for (std::size_t p = 0; p < 3; ++p) {
+                    if (p != largest) mkqs(parts[p].a, parts[p].n, parts[p].depth);
+                }
+                a = parts[largest].a;
+                n = parts[largest].n;
+                depth = parts[largest].depth;
+            }
+            insertion_sort(a, n, depth);
+        }
+
+        inline std::size_t common_prefix(const Item& a, const Item& b) {
+            std::size_t n = std::min(a.len, b.len), i = 0;
+            while (i + 8 <= n && load_chars(a.str + i, 8) == load_chars(b.str + i, 8)) i += 8;
+            while (i < n && a.str[i] == b.str[i]) ++i;
+            return i;
+        }
+
+        // Sorts [begin, end) and, if lcp is not null, stores the length of the longest common
+        // prefix of every string and the one before it (0 for the first) into it.
+        template<class Iter>
+        inline void string_sort(Iter begin, Iter end, std::vector<std::size_t>* lcp) {
+            std::size_t n = std::size_t(end - begin);
+            std::vector<Item> items(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::string_view s(begin[i]);
+                items[i] = Item{ 0, s.data(), s.size(), i };
+            }
+            fill_cache(items.data(), n, 0);
+            mkqs(items.data(), n, 0);
+
+            // The items point into the strings, which may move below.
+            if (lcp) {
+                lcp->assign(n, 0);
+                for (std::size_t i = 1; i < n; ++i) (*lcp)[i] = common_prefix(items[i - 1], items[i]);
+            }
+
+            // Gather the elements in sorted order, then move them back. The reads are random but
+            // prefetched ahead, the writes are sequential, unlike when following the cycles of
+            // the permutation in place.
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            std::vector<T> sorted;
+            sorted.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+#if defined(__GNUC__) || defined(__clang__)
+                if (i + 8 < n) __builtin_prefetch(std::addressof(begin[items[i + 8].idx]));
+#endif
+                sorted.push_back(std::move(begin[items[i].idx]));
+            }
+            std::move(sorted.begin(), sorted.end(), begin);
+        }
+    }
+
+    // Sorts a range of std::string, std::string_view, const char* or anything else convertible
+    // to std::string_view, in lexicographic order of the characters as unsigned char.
+    // Unstable, uses O(n) memory: 32 bytes per string plus a temporary copy of the elements.
+    template<class Iter>
+    inline void string_sort(Iter begin, Iter end) {
+        string_sort_detail::string_sort(begin, end, nullptr);
+    }
+
+    // Same, and fills lcp with the longest common prefix of every string and the previous one.
+    template<class Iter>
+    inline void string_sort(Iter begin, Iter end, std::vector<std::size_t>& lcp) {
+        string_sort_detail::string_sort(begin, end, &lcp);
+    }
+}
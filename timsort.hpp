@@ -60,9 +60,15 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "mayanmem.hpp"
+#include "mayanpar.hpp"
+#include "mayansimd.hpp"
+#include "mayantrace.hpp"
+
  // Semantic versioning macros
 
 #define GFX_TIMSORT_VERSION_MAJOR 2
@@ -147,7 +153,11 @@ namespace MayanSort {
                 }
             };
 
-            template <typename RandomAccessIterator, typename Compare> class TimSort {
+            template <typename RandomAccessIterator, typename Compare,
+                typename Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+            class TimSort {
+                template <typename, typename, typename> friend class TimSort;
+
                 typedef RandomAccessIterator iter_t;
                 typedef typename std::iterator_traits<iter_t>::value_type value_t;
                 typedef typename std::iterator_traits<iter_t>::reference ref_t;
@@ -156,12 +166,20 @@ namespace MayanSort {
                 static constexpr int MIN_MERGE = 32;
                 static constexpr int MIN_GALLOP = 7;
 
+                // Parallel mode: smallest chunk scanned for runs by one task, and smallest merge
+                // that is split between two tasks.
+                static constexpr diff_t PARALLEL_MIN_CHUNK = 1 << 14;
+                static constexpr diff_t PARALLEL_MIN_MERGE = 1 << 15;
+
                 int minGallop_; // default to MIN_GALLOP
 
-                std::vector<value_t> tmp_; // temp storage for merges
-                typedef typename std::vector<value_t>::iterator tmp_iter_t;
+                typedef _mem::rebind_t<Allocator, value_t> tmp_alloc_t;
+                typedef _mem::rebind_t<Allocator, run<RandomAccessIterator> > pending_alloc_t;
 
-                std::vector<run<RandomAccessIterator> > pending_;
+                std::vector<value_t, tmp_alloc_t> tmp_; // temp storage for merges
+                typedef typename std::vector<value_t, tmp_alloc_t>::iterator tmp_iter_t;
+
+                std::vector<run<RandomAccessIterator>, pending_alloc_t> pending_;
 
                 static void binarySort(iter_t const lo, iter_t const hi, iter_t start, Compare compare) {
                     GFX_TIMSORT_ASSERT(lo <= start);
@@ -189,16 +207,13 @@ namespace MayanSort {
                         return 1;
                     }
 
+                    // The run is scanned with vectors for arithmetic keys, see mayansimd.hpp.
                     if (compare(*runHi, *lo)) { // decreasing
-                        do {
-                            ++runHi;
-                        } while (runHi < hi && compare(*runHi, *std::prev(runHi)));
+                        runHi = _simd::run_end<true, true>(runHi, hi, compare);
                         std::reverse(lo, runHi);
                     }
                     else { // non-decreasing
-                        do {
-                            ++runHi;
-                        } while (runHi < hi && !compare(*runHi, *std::prev(runHi)));
+                        runHi = _simd::run_end<false, false>(runHi, hi, compare);
                     }
 
                     return runHi - lo;
@@ -215,12 +230,10 @@ namespace MayanSort {
                     return n + r;
                 }
 
-                TimSort() : minGallop_(MIN_GALLOP) {
+                explicit TimSort(Allocator const& alloc = Allocator())
+                    : minGallop_(MIN_GALLOP), tmp_(tmp_alloc_t(alloc)), pending_(pending_alloc_t(alloc)) {
                 }
 
-                // Silence GCC -Winline warning
-                ~TimSort() {}
-
                 void pushRun(iter_t const runBase, diff_t const runLen) {
                     pending_.emplace_back(runBase, runLen);
                 }
@@ -282,6 +295,7 @@ namespace MayanSort {
                     GFX_TIMSORT_ASSERT(len1 > 0);
                     GFX_TIMSORT_ASSERT(len2 > 0);
                     GFX_TIMSORT_ASSERT(base1 + len1 == base2);
+                    _TracePhase("timsort.merge", len1 + len2);
 
                     diff_t const k = gallopRight(*base2, base1, len1, 0, compare);
                     GFX_TIMSORT_ASSERT(k >= 0);
@@ -454,34 +468,75 @@ namespace MayanSort {
 
                     // outer:
                     while (true) {
+                        // Arithmetic keys are merged a block of vectors at a time until one run
+                        // keeps winning, which is left to the loops below (see mayansimd.hpp).
+                        std::size_t taken1, taken2;
+                        if (_simd::merge<false>(cursor1, cursor1 + len1, cursor2, cursor2 + len2, dest, compare, taken1, taken2)) {
+                            cursor1 += diff_t(taken1);
+                            cursor2 += diff_t(taken2);
+                            dest += diff_t(taken1 + taken2);
+                            len1 -= diff_t(taken1);
+                            len2 -= diff_t(taken2);
+                        }
+
                         diff_t count1 = 0;
                         diff_t count2 = 0;
 
-                        do {
-                            GFX_TIMSORT_ASSERT(len1 > 1);
-                            GFX_TIMSORT_ASSERT(len2 > 0);
-
-                            if (compare(*cursor2, *cursor1)) {
-                                *dest = std::move(*cursor2);
-                                ++cursor2;
+                        if constexpr (_simd::branchless_merge<value_t, Compare>) {
+                            // Same loop with the element selected by a conditional move, counting
+                            // the wins in a row of either run.
+                            diff_t count = 0;
+                            bool last2 = false;
+                            while (true) {
+                                GFX_TIMSORT_ASSERT(len1 > 1);
+                                GFX_TIMSORT_ASSERT(len2 > 0);
+
+                                value_t const v1 = *cursor1;
+                                value_t const v2 = *cursor2;
+                                bool const take2 = compare(v2, v1);
+                                *dest = take2 ? v2 : v1;
                                 ++dest;
-                                ++count2;
-                                count1 = 0;
-                                if (--len2 == 0) {
+                                cursor1 += diff_t(!take2);
+                                cursor2 += diff_t(take2);
+                                len1 -= diff_t(!take2);
+                                len2 -= diff_t(take2);
+                                count = (count & -diff_t(take2 == last2)) + 1;
+                                last2 = take2;
+                                if ((len2 == 0) | (len1 == 1)) {
                                     goto epilogue;
                                 }
-                            }
-                            else {
-                                *dest = std::move(*cursor1);
-                                ++cursor1;
-                                ++dest;
-                                ++count1;
-                                count2 = 0;
-                                if (--len1 == 1) {
-                                    goto epilogue;
+                                if (count >= minGallop) {
+                                    break;
                                 }
                             }
-                        } while ((count1 | count2) < minGallop);
+                        }
+                        else {
+                            do {
+                                GFX_TIMSORT_ASSERT(len1 > 1);
+                                GFX_TIMSORT_ASSERT(len2 > 0);
+
+                                if (compare(*cursor2, *cursor1)) {
+                                    *dest = std::move(*cursor2);
+                                    ++cursor2;
+                                    ++dest;
+                                    ++count2;
+                                    count1 = 0;
+                                    if (--len2 == 0) {
+                                        goto epilogue;
+                                    }
+                                }
+                                else {
+                                    *dest = std::move(*cursor1);
+                                    ++cursor1;
+                                    ++dest;
+                                    ++count1;
+                                    count2 = 0;
+                                    if (--len1 == 1) {
+                                        goto epilogue;
+                                    }
+                                }
+                            } while ((count1 | count2) < minGallop);
+                        }
 
                         do {
                             GFX_TIMSORT_ASSERT(len1 > 1);
@@ -574,42 +629,81 @@ namespace MayanSort {
 
                     // outer:
                     while (true) {
+                        // Same as in mergeLo, from the ends of the runs.
+                        std::size_t taken1, taken2;
+                        if (_simd::merge<true>(tmp_.begin(), cursor2 + 1, cursor1 - len1, cursor1, dest + 1, compare, taken2, taken1)) {
+                            cursor1 -= diff_t(taken1);
+                            cursor2 -= diff_t(taken2);
+                            dest -= diff_t(taken1 + taken2);
+                            len1 -= diff_t(taken1);
+                            len2 -= diff_t(taken2);
+                        }
+
                         diff_t count1 = 0;
                         diff_t count2 = 0;
 
-                        // The next loop is a hot path of the algorithm, so we decrement
-                        // eagerly the cursor so that it always points directly to the value
-                        // to compare, but we have to implement some trickier logic to make
-                        // sure that it points to the next value again by the end of said loop
-                        --cursor1;
-
-                        do {
-                            GFX_TIMSORT_ASSERT(len1 > 0);
-                            GFX_TIMSORT_ASSERT(len2 > 1);
-
-                            if (compare(*cursor2, *cursor1)) {
-                                *dest = std::move(*cursor1);
+                        if constexpr (_simd::branchless_merge<value_t, Compare>) {
+                            // Same as in mergeLo.
+                            diff_t count = 0;
+                            bool last1 = false;
+                            while (true) {
+                                GFX_TIMSORT_ASSERT(len1 > 0);
+                                GFX_TIMSORT_ASSERT(len2 > 1);
+
+                                value_t const v1 = *(cursor1 - 1);
+                                value_t const v2 = *cursor2;
+                                bool const take1 = compare(v2, v1);
+                                *dest = take1 ? v1 : v2;
                                 --dest;
-                                ++count1;
-                                count2 = 0;
-                                if (--len1 == 0) {
+                                cursor1 -= diff_t(take1);
+                                cursor2 -= diff_t(!take1);
+                                len1 -= diff_t(take1);
+                                len2 -= diff_t(!take1);
+                                count = (count & -diff_t(take1 == last1)) + 1;
+                                last1 = take1;
+                                if ((len1 == 0) | (len2 == 1)) {
                                     goto epilogue;
                                 }
-                                --cursor1;
-                            }
-                            else {
-                                *dest = std::move(*cursor2);
-                                --cursor2;
-                                --dest;
-                                ++count2;
-                                count1 = 0;
-                                if (--len2 == 1) {
-                                    ++cursor1; // See comment before the loop
-                                    goto epilogue;
+                                if (count >= minGallop) {
+                                    break;
                                 }
                             }
-                        } while ((count1 | count2) < minGallop);
-                        ++cursor1; // See comment before the loop
+                        }
+                        else {
+                            // The next loop is a hot path of the algorithm, so we decrement
+                            // eagerly the cursor so that it always points directly to the value
+                            // to compare, but we have to implement some trickier logic to make
+                            // sure that it points to the next value again by the end of said loop
+                            --cursor1;
+
+                            do {
+                                GFX_TIMSORT_ASSERT(len1 > 0);
+                                GFX_TIMSORT_ASSERT(len2 > 1);
+
+                                if (compare(*cursor2, *cursor1)) {
+                                    *dest = std::move(*cursor1);
+                                    --dest;
+                                    ++count1;
+                                    count2 = 0;
+                                    if (--len1 == 0) {
+                                        goto epilogue;
+                                    }
+                                    --cursor1;
+                                }
+                                else {
+                                    *dest = std::move(*cursor2);
+                                    --cursor2;
+                                    --dest;
+                                    ++count2;
+                                    count1 = 0;
+                                    if (--len2 == 1) {
+                                        ++cursor1; // See comment before the loop
+                                        goto epilogue;
+                                    }
+                                }
+                            } while ((count1 | count2) < minGallop);
+                            ++cursor1; // See comment before the loop
+                        }
 
                         do {
                             GFX_TIMSORT_ASSERT(len1 > 0);
@@ -677,12 +771,225 @@ namespace MayanSort {
                 }
 
                 void copy_to_tmp(iter_t const begin, diff_t len) {
+                    // The old buffer is given back before a larger one is taken, see scratchBytes().
+                    if (static_cast<std::size_t>(len) > tmp_.capacity()) {
+                        std::vector<value_t, tmp_alloc_t>(tmp_.get_allocator()).swap(tmp_);
+                    }
                     tmp_.assign(std::make_move_iterator(begin),
                         std::make_move_iterator(begin + len));
                 }
 
+                // Finds the natural runs of [lo, hi) the same way sort() does, extending short ones
+                // to minRun with binarySort, and appends them to runs.
+                static void collectRuns(iter_t const lo, iter_t const hi, diff_t const minRun,
+                    std::vector<run<RandomAccessIterator> >& runs, Compare compare) {
+                    diff_t nRemaining = hi - lo;
+                    iter_t cur = lo;
+                    while (nRemaining != 0) {
+                        _TracePhaseAs(runPhase, "timsort.run", nRemaining);
+                        diff_t runLen = countRunAndMakeAscending(cur, hi, compare);
+
+                        if (runLen < minRun) {
+                            diff_t const force = (std::min)(nRemaining, minRun);
+                            binarySort(cur, cur + force, cur + runLen, compare);
+                            runLen = force;
+                        }
+                        _TraceCount(runPhase, runLen);
+
+                        runs.emplace_back(cur, runLen);
+                        cur += runLen;
+                        nRemaining -= runLen;
+                    }
+                }
+
+                typedef TimSort<value_t*, Compare, Allocator> LeafMerger;
+                typedef std::allocator_traits<tmp_alloc_t> slot_traits;
+
+                // Memory of the parallel merges: a raw slot for every element, where a merge puts
+                // its output before moving it back, and the TimSort objects that merge the leaves,
+                // with buffers reserved up front. A merger is taken by one leaf at a time. All of
+                // it comes from the sort's allocator, on the calling thread.
+                class ParallelScratch {
+                    std::vector<LeafMerger> mergers_;
+                    std::unique_ptr<std::atomic<bool>[]> busy_;
+                    tmp_alloc_t alloc_;
+                    std::size_t size_;
+                    typename slot_traits::pointer slots_;
+
+                    static std::vector<LeafMerger> makeMergers(std::size_t count, Allocator const& alloc) {
+                        std::vector<LeafMerger> mergers(count, LeafMerger(alloc));
+                        for (LeafMerger& merger : mergers) {
+                            merger.tmp_.reserve(PARALLEL_MIN_MERGE / 2);
+                        }
+                        return mergers;
+                    }
+
+                public:
+                    ParallelScratch(std::size_t size, std::size_t mergers, Allocator const& alloc)
+                        : mergers_(makeMergers(mergers, alloc)), busy_(new std::atomic<bool>[mergers]()),
+                        alloc_(alloc), size_(size), slots_(slot_traits::allocate(alloc_, size)) {
+                    }
+
+                    ~ParallelScratch() {
+                        slot_traits::deallocate(alloc_, slots_, size_);
+                    }
+
+                    ParallelScratch(ParallelScratch const&) = delete;
+                    ParallelScratch& operator=(ParallelScratch const&) = delete;
+
+                    value_t* slots() const {
+                        return std::to_address(slots_);
+                    }
+
+                    // Calls f with a merger no other thread is using.
+                    template <typename F>
+                    void withMerger(F f) {
+                        std::size_t i = 0;
+                        while (busy_[i].exchange(true, std::memory_order_acquire)) {
+                            if (++i == mergers_.size()) {
+                                i = 0;
+                                std::this_thread::yield();
+                            }
+                        }
+                        struct release {
+                            std::atomic<bool>& flag;
+                            ~release() { flag.store(false, std::memory_order_release); }
+                        } const guard = { busy_[i] };
+                        f(mergers_[i]);
+                    }
+                };
+
+                // Moves the stable merge of [base1, base1 + len1) and [base2, base2 + len2) into
+                // the raw slots at out: both parts are moved there side by side, then merged in
+                // place by the galloping merge of merger.
+                static void mergeInto(LeafMerger& merger, iter_t const base1, diff_t const len1,
+                    iter_t const base2, diff_t const len2, value_t* const out, Compare compare) {
+                    value_t* const mid = std::uninitialized_move(base1, base1 + len1, out);
+                    try {
+                        std::uninitialized_move(base2, base2 + len2, mid);
+                    }
+                    catch (...) {
+                        std::destroy(out, mid);
+                        throw;
+                    }
+                    if (len1 != 0 && len2 != 0) {
+                        try {
+                            merger.mergeConsecutiveRuns(out, len1, mid, len2, compare);
+                        }
+                        catch (...) {
+                            std::destroy(out, mid + len2);
+                            throw;
+                        }
+                    }
+                }
+
+                // Moves the stable merge of [base1, base1 + len1) and [base2, base2 + len2) into
+                // the raw slots at out. Large merges are split in two independent merges: the
+                // longer run is cut in its middle and the matching cut of the other run is found
+                // by binary search, which also gives where the second merge starts in out.
+                static void parallelMergeInto(_parallel::TaskPool& pool, ParallelScratch& scratch,
+                    iter_t const base1, diff_t const len1, iter_t const base2, diff_t const len2,
+                    value_t* const out, Compare compare) {
+                    if (len1 + len2 < PARALLEL_MIN_MERGE) {
+                        scratch.withMerger([&](LeafMerger& merger) {
+                            mergeInto(merger, base1, len1, base2, len2, out, compare);
+                        });
+                        return;
+                    }
+
+                    diff_t cut1, cut2;
+                    if (len1 >= len2) {
+                        cut1 = len1 / 2;
+                        cut2 = std::lower_bound(base2, base2 + len2, *(base1 + cut1), compare) - base2;
+                    }
+                    else {
+                        cut2 = len2 / 2;
+                        cut1 = std::upper_bound(base1, base1 + len1, *(base2 + cut2), compare) - base1;
+                    }
+
+                    _parallel::TaskGroup group;
+                    pool.spawn(group, [&pool, &scratch, base1, cut1, base2, cut2, out, compare]() {
+                        parallelMergeInto(pool, scratch, base1, cut1, base2, cut2, out, compare);
+                    });
+                    parallelMergeInto(pool, scratch, base1 + cut1, len1 - cut1, base2 + cut2, len2 - cut2,
+                        out + (cut1 + cut2), compare);
+                    pool.wait(group);
+                }
+
+                // Stably merges the consecutive runs [base1, base2) and [base2, base2 + len2)
+                // through the scratch slots at the same offset as base1. The elements already in
+                // place at both ends are left alone, the rest is merged into the slots and moved
+                // back in one block per thread.
+                static void parallelMerge(_parallel::TaskPool& pool, ParallelScratch& scratch, iter_t const origin,
+                    iter_t const base1, iter_t const base2, diff_t const len2, Compare compare) {
+                    if (base1 == base2 || len2 == 0 || !compare(*base2, *(base2 - 1))) {
+                        return;
+                    }
+
+                    iter_t const first = std::upper_bound(base1, base2, *base2, compare);
+                    iter_t const last = std::lower_bound(base2, base2 + len2, *(base2 - 1), compare);
+                    value_t* const out = scratch.slots() + (first - origin);
+                    parallelMergeInto(pool, scratch, first, base2 - first, base2, last - base2, out, compare);
+
+                    diff_t const len = last - first;
+                    diff_t const parts = (std::min)(diff_t(pool.size()), len / PARALLEL_MIN_MERGE + 1);
+                    pool.parallel_for(std::size_t(parts), [&](std::size_t p) {
+                        diff_t const from = len * diff_t(p) / parts;
+                        diff_t const to = len * diff_t(p + 1) / parts;
+                        std::move(out + from, out + to, first + from);
+                        std::destroy(out + from, out + to);
+                    });
+                }
+
+                // Merges runs[0, count) as a balanced tree, both subtrees being merged concurrently.
+                // The scratch slots start at origin.
+                static void parallelMergeRuns(_parallel::TaskPool& pool, ParallelScratch& scratch, iter_t const origin,
+                    run<RandomAccessIterator> const* runs, std::size_t const count, Compare compare) {
+                    if (count < 2) {
+                        return;
+                    }
+
+                    // Split where both halves hold about the same number of elements.
+                    iter_t const lo = runs[0].base;
+                    iter_t const hi = runs[count - 1].base + runs[count - 1].len;
+                    iter_t const half = lo + (hi - lo) / 2;
+                    std::size_t mid = 1;
+                    while (mid < count - 1 && runs[mid].base + runs[mid].len <= half) {
+                        ++mid;
+                    }
+
+                    if (hi - lo < PARALLEL_MIN_MERGE) {
+                        parallelMergeRuns(pool, scratch, origin, runs, mid, compare);
+                        parallelMergeRuns(pool, scratch, origin, runs + mid, count - mid, compare);
+                    }
+                    else {
+                        _parallel::TaskGroup group;
+                        pool.spawn(group, [&pool, &scratch, origin, runs, mid, compare]() {
+                            parallelMergeRuns(pool, scratch, origin, runs, mid, compare);
+                        });
+                        parallelMergeRuns(pool, scratch, origin, runs + mid, count - mid, compare);
+                        pool.wait(group);
+                    }
+
+                    iter_t const base2 = runs[mid].base;
+                    parallelMerge(pool, scratch, origin, lo, base2, hi - base2, compare);
+                }
+
             public:
 
+                // Silence GCC -Winline warning
+                ~TimSort() {}
+
+                // Most bytes sort() takes from its allocator for n elements: a merge copies the
+                // shorter run, at most n / 2 elements, and the run stack stays below 128 runs
+                // for any n, so it holds at most 192 while it grows.
+                static std::size_t scratchBytes(diff_t n) {
+                    if (n < MIN_MERGE) {
+                        return 0;
+                    }
+                    return static_cast<std::size_t>(n / 2) * sizeof(value_t) + 192 * sizeof(run<RandomAccessIterator>);
+                }
+
                 static void merge(iter_t const lo, iter_t const mid, iter_t const hi, Compare compare) {
                     GFX_TIMSORT_ASSERT(lo <= mid);
                     GFX_TIMSORT_ASSERT(mid <= hi);
@@ -698,31 +1005,39 @@ namespace MayanSort {
                         << "; tmp_.size(): " << ts.tmp_.size());
                 }
 
-                static void sort(iter_t const lo, iter_t const hi, Compare compare) {
+                static void sort(iter_t const lo, iter_t const hi, Compare compare,
+                    Allocator const& alloc = Allocator()) {
                     GFX_TIMSORT_ASSERT(lo <= hi);
 
                     diff_t nRemaining = (hi - lo);
                     if (nRemaining < 2) {
                         return; // nothing to do
                     }
+                    _TracePhase("timsort", nRemaining);
 
                     if (nRemaining < MIN_MERGE) {
+                        _TracePhase("timsort.run", nRemaining);
                         diff_t const initRunLen = countRunAndMakeAscending(lo, hi, compare);
                         GFX_TIMSORT_LOG("initRunLen: " << initRunLen);
                         binarySort(lo, hi, lo + initRunLen, compare);
                         return;
                     }
 
-                    TimSort ts;
+                    TimSort ts(alloc);
                     diff_t const minRun = minRunLength(nRemaining);
                     iter_t cur = lo;
                     do {
-                        diff_t runLen = countRunAndMakeAscending(cur, hi, compare);
-
-                        if (runLen < minRun) {
-                            diff_t const force = (std::min)(nRemaining, minRun);
-                            binarySort(cur, cur + force, cur + runLen, compare);
-                            runLen = force;
+                        diff_t runLen;
+                        {
+                            _TracePhaseAs(runPhase, "timsort.run", nRemaining);
+                            runLen = countRunAndMakeAscending(cur, hi, compare);
+
+                            if (runLen < minRun) {
+                                diff_t const force = (std::min)(nRemaining, minRun);
+                                binarySort(cur, cur + force, cur + runLen, compare);
+                                runLen = force;
+                            }
+                            _TraceCount(runPhase, runLen);
                         }
 
                         ts.pushRun(cur, runLen);
@@ -739,6 +1054,54 @@ namespace MayanSort {
                     GFX_TIMSORT_LOG("size: " << (hi - lo) << " tmp_.size(): " << ts.tmp_.size()
                         << " pending_.size(): " << ts.pending_.size());
                 }
+
+                // Parallel mode of sort(): the range is cut in chunks whose runs are found
+                // concurrently, runs that continue across a cut are joined, then the runs are
+                // merged as a balanced tree. Being stable, the result is the one of sort().
+                static void parallelSort(iter_t const lo, iter_t const hi, Compare compare, unsigned threads,
+                    Allocator const& alloc = Allocator()) {
+                    GFX_TIMSORT_ASSERT(lo <= hi);
+
+                    diff_t const n = hi - lo;
+                    if (threads == 0) {
+                        threads = _parallel::default_threads();
+                    }
+                    if (threads == 1 || n < 2 * PARALLEL_MIN_CHUNK) {
+                        return sort(lo, hi, compare, alloc);
+                    }
+                    _TracePhase("timsort", n);
+
+                    _parallel::TaskPool pool(threads);
+                    std::size_t const chunks = (std::min)(std::size_t(4) * threads, std::size_t(n / PARALLEL_MIN_CHUNK));
+                    diff_t const minRun = minRunLength(n);
+
+                    std::vector<std::vector<run<RandomAccessIterator> > > chunkRuns(chunks);
+                    pool.parallel_for(chunks, [&](std::size_t i) {
+                        iter_t const first = lo + n * diff_t(i) / diff_t(chunks);
+                        iter_t const last = lo + n * diff_t(i + 1) / diff_t(chunks);
+                        collectRuns(first, last, minRun, chunkRuns[i], compare);
+                    });
+
+                    // Stitch the runs of consecutive chunks when they are already in order.
+                    std::vector<run<RandomAccessIterator> > runs;
+                    for (std::size_t i = 0; i < chunks; ++i) {
+                        for (run<RandomAccessIterator> const& r : chunkRuns[i]) {
+                            if (!runs.empty() && &r == &chunkRuns[i].front()
+                                && !compare(*r.base, *(r.base - 1))) {
+                                runs.back().len += r.len;
+                            }
+                            else {
+                                runs.push_back(r);
+                            }
+                        }
+                    }
+
+                    GFX_TIMSORT_LOG("chunks: " << chunks << " runs: " << runs.size());
+
+                    // The leaves run on the workers and on this thread while it waits.
+                    ParallelScratch scratch(static_cast<std::size_t>(n), pool.size() + 1, alloc);
+                    parallelMergeRuns(pool, scratch, lo, runs.data(), runs.size(), compare);
+                }
             };
 
         } // namespace detail
@@ -768,18 +1131,40 @@ namespace MayanSort {
         }
 
         /**
-         * Stably sorts a range with a comparison function and a projection function.
+         * Stably sorts a range with a comparison function and a projection function. The temporary
+         * storage is taken from alloc, rebound to the element type (see mayanmem.hpp).
          */
         template <
             typename RandomAccessIterator,
             typename Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>,
-            typename Projection = detail::identity
+            typename Projection = detail::identity,
+            typename Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type>
         >
             void timsort(RandomAccessIterator const first, RandomAccessIterator const last,
-                Compare compare = {}, Projection projection = {}) {
+                Compare compare = {}, Projection projection = {}, Allocator const& alloc = Allocator()) {
             typedef detail::projection_compare<Compare, Projection> compare_t;
             compare_t comp(std::move(compare), std::move(projection));
-            detail::TimSort<RandomAccessIterator, compare_t>::sort(first, last, comp);
+            detail::TimSort<RandomAccessIterator, compare_t, Allocator>::sort(first, last, comp, alloc);
+            GFX_TIMSORT_AUDIT(std::is_sorted(first, last, comp) && "Postcondition");
+        }
+
+        /**
+         * Stably sorts a range with a comparison function and a projection function, using
+         * `threads` threads of the shared pool (0 means all). The result is the one of timsort, and
+         * the temporary storage is taken from alloc the same way.
+         */
+        template <
+            typename RandomAccessIterator,
+            typename Compare = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>,
+            typename Projection = detail::identity,
+            typename Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type>
+        >
+            void parallel_timsort(RandomAccessIterator const first, RandomAccessIterator const last,
+                Compare compare = {}, Projection projection = {}, unsigned threads = 0,
+                Allocator const& alloc = Allocator()) {
+            typedef detail::projection_compare<Compare, Projection> compare_t;
+            compare_t comp(std::move(compare), std::move(projection));
+            detail::TimSort<RandomAccessIterator, compare_t, Allocator>::parallelSort(first, last, comp, threads, alloc);
             GFX_TIMSORT_AUDIT(std::is_sorted(first, last, comp) && "Postcondition");
         }
 
@@ -798,6 +1183,12 @@ namespace MayanSort {
         }
 
     } // namespace gfx
+
+    namespace _simd {
+        template <typename Compare, typename T>
+        struct compare_direction<gfx::detail::projection_compare<Compare, gfx::detail::identity>, T>
+            : compare_direction<Compare, T> {};
+    }
 }
 
 #undef GFX_TIMSORT_ENABLE_ASSERT
@@ -75,6 +75,8 @@
 #include <list>
 #include <utility>
 
+#include "mayansimd.hpp"
+
 #if __cplusplus >= 201103L
 #include <cstdint>
 #include <type_traits>
@@ -212,8 +214,9 @@ namespace MayanSort {
                 // Must be multiple of 8 due to loop unrolling, and < 256 to fit in unsigned char.
                 block_size = 64,
 
-                // Cacheline size, assumes power of two.
-                cacheline_size = 64
+                // Largest cacheline size the offset buffers are aligned to. The actual size is
+                // detected at run time (see mayansimd.hpp).
+                max_cacheline_size = 128
             };
 
             // Sorts [begin, end) using insertion sort with the given comparison function. Assumes
@@ -274,7 +277,8 @@ namespace MayanSort {
 #else
                 std::size_t ip = reinterpret_cast<std::size_t>(p);
 #endif
-                ip = (ip + cacheline_size - 1) & -cacheline_size;
+                std::size_t line = std::min<std::size_t>(_simd::cacheline_size(), max_cacheline_size);
+                ip = (ip + line - 1) & ~(line - 1);
                 return reinterpret_cast<T*>(ip);
             }
 
@@ -338,8 +342,8 @@ namespace MayanSort {
 
                 // The following branchless partitioning is derived from "BlockQuicksort: How Branch
                 // Mispredictions dont affect Quicksort" by Stefan Edelkamp and Armin Weiss.
-                unsigned char offsets_l_storage[block_size + cacheline_size];
-                unsigned char offsets_r_storage[block_size + cacheline_size];
+                unsigned char offsets_l_storage[block_size + max_cacheline_size];
+                unsigned char offsets_r_storage[block_size + max_cacheline_size];
                 unsigned char* offsets_l = align_cacheline(offsets_l_storage);
                 unsigned char* offsets_r = align_cacheline(offsets_r_storage);
                 int num_l, num_r, start_l, start_r;
@@ -536,6 +540,9 @@ namespace MayanSort {
                 while (true) {
                     diff_t size = end - begin;
 
+                    // Same small-partition kernel as pdqsort.hpp.
+                    if (_simd::network_sort(begin, end, comp)) return;
+
                     // Insertion sort is faster for small arrays.
                     if (size < insertion_sort_threshold) {
                         if (leftmost) insertion_sort(begin, end, comp);
@@ -921,7 +928,8 @@ namespace MayanSort {
                     current += unstable_limit;
                     next += unstable_limit;
 
-                    // Set forward iterators
+                    // Set forward iterators, the forward runs are scanned with vectors
+                    // for arithmetic keys (see mayansimd.hpp)
                     RandomAccessIterator current2 = current;
                     RandomAccessIterator next2 = next;
 
@@ -935,13 +943,8 @@ namespace MayanSort {
                         } while (current != begin_range);
                         if (compare(*current, *next)) ++current;
 
-                        ++current2;
-                        ++next2;
-                        while (next2 != last) {
-                            if (compare(*current2, *next2)) break;
-                            ++current2;
-                            ++next2;
-                        }
+                        next2 = _simd::run_end<true, false>(next2, last, compare);
+                        current2 = detail::prev(next2);
 
                         // Check whether we found a big enough sorted sequence
                         if ((next2 - current) >= unstable_limit) {
@@ -973,13 +976,8 @@ namespace MayanSort {
                         } while (current != begin_range);
                         if (compare(*next, *current)) ++current;
 
-                        ++current2;
-                        ++next2;
-                        while (next2 != last) {
-                            if (compare(*next2, *current2)) break;
-                            ++current2;
-                            ++next2;
-                        }
+                        next2 = _simd::run_end<false, false>(next2, last, compare);
+                        current2 = detail::prev(next2);
 
                         // Check whether we found a big enough sorted sequence
                         if ((next2 - current) >= unstable_limit) {
@@ -41,8 +41,13 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
 #include <vector>
 
+#include "mayanmem.hpp"
+#include "mayansimd.hpp"
+
 // record the number of comparisons and assignments
 // note that this reduces WikiSort's performance when enabled
 #define PROFILE false
@@ -191,6 +196,20 @@ namespace MayanSort {
     }
 
     namespace Wiki {
+        // std::merge into a separate output, with arithmetic keys merged a block of vectors at a time
+        template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Comparison>
+        RandomAccessIterator2 MergeInto(RandomAccessIterator1 first1, RandomAccessIterator1 last1,
+            RandomAccessIterator1 first2, RandomAccessIterator1 last2,
+            RandomAccessIterator2 result, Comparison compare) {
+            std::size_t taken1, taken2;
+            while (_simd::merge<false>(first1, last1, first2, last2, result, compare, taken1, taken2)) {
+                first1 += taken1;
+                first2 += taken2;
+                result += taken1 + taken2;
+            }
+            return std::merge(first1, last1, first2, last2, result, compare);
+        }
+
         // merge operation using an external buffer
         template <typename RandomAccessIterator1, typename RandomAccessIterator2, typename Comparison>
         void MergeExternal(RandomAccessIterator1 first1, RandomAccessIterator1 last1,
@@ -203,6 +222,14 @@ namespace MayanSort {
             RandomAccessIterator1 B_last = last2;
             RandomAccessIterator1 insert_index = first1;
 
+            // arithmetic keys are merged a block of vectors at a time while both sides are long enough
+            std::size_t taken1, taken2;
+            while (_simd::merge<false>(A_index, A_last, B_index, B_last, insert_index, compare, taken1, taken2)) {
+                A_index += taken1;
+                B_index += taken2;
+                insert_index += taken1 + taken2;
+            }
+
             if (last2 - first2 > 0 && last1 - first1 > 0) {
                 while (true) {
                     if (!compare(*B_index, *A_index)) {
@@ -360,34 +387,53 @@ namespace MayanSort {
 #if DYNAMIC_CACHE
         // use a class so the memory for the cache is freed when the object goes out of scope,
         // regardless of whether exceptions were thrown (only needed in the C++ version)
-        template <typename T>
+        // the memory comes from the allocator given to Sort()
+        template <typename T, typename Allocator = std::allocator<T> >
         class Cache {
+            _mem::buffer<T, Allocator> buffer;
+
+            bool allocate() {
+                try {
+                    cache = buffer.reserve(cache_size);
+                    return true;
+                }
+                catch (const std::bad_alloc&) {
+                    return false;
+                }
+            }
+
         public:
             T* cache;
             std::size_t cache_size;
 
-            ~Cache() {
-                if (cache) delete[] cache;
+            // the cache starts out uninitialized, and the first count items are constructed here
+            // (from the items of the array, which keep their values) before they are written to
+            template <typename RandomAccessIterator>
+            void Prime(RandomAccessIterator first, std::size_t count) {
+                buffer.prime(first, count);
             }
 
-            Cache(std::size_t size) {
+            // the smallest cache the constructor tries for size elements (without counting 0)
+            static std::size_t MinimumSize(std::size_t size) {
+                std::size_t sqrt_size = std::sqrt((size + 1) / 2) + 1;
+                return sqrt_size > 512 ? 512 : sqrt_size;
+            }
+
+            Cache(std::size_t size, const Allocator& alloc = Allocator()) : buffer(alloc), cache(nullptr) {
                 // good choices for the cache size are:
                 // (size + 1)/2 C turns into a full-speed standard merge sort since everything fits into the cache
                 cache_size = (size + 1) / 2;
-                cache = new (std::nothrow) T[cache_size];
-                if (cache) return;
+                if (allocate()) return;
 
                 // sqrt((size + 1)/2) + 1 C this will be the size of the A blocks at the largest level of merges,
                 // so a buffer of this size would allow it to skip using internal or in-place merges for anything
                 cache_size = std::sqrt(cache_size) + 1;
-                cache = new (std::nothrow) T[cache_size];
-                if (cache) return;
+                if (allocate()) return;
 
                 // 512 C chosen from careful testing as a good balance between fixed-size memory use and run time
                 if (cache_size > 512) {
                     cache_size = 512;
-                    cache = new (std::nothrow) T[cache_size];
-                    if (cache) return;
+                    if (allocate()) return;
                 }
 
                 // 0 C if the system simply cannot allocate any extra memory whatsoever, no memory works just fine
@@ -397,8 +443,11 @@ namespace MayanSort {
 #endif
 
         // bottom-up merge sort combined with an in-place merge algorithm for O(1) memory use
-        template <typename RandomAccessIterator, typename Comparison>
-        void Sort(RandomAccessIterator first, RandomAccessIterator last, Comparison compare) {
+        // (the cache is taken from alloc, rebound to the element type, see mayanmem.hpp)
+        template <typename RandomAccessIterator, typename Comparison,
+            typename Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type> >
+        void Sort(RandomAccessIterator first, RandomAccessIterator last, Comparison compare,
+            const Allocator& alloc = Allocator()) {
             // map first and last to a C-style array, so we don't have to change the rest of the code
             // (bit of a nasty hack, but it's good enough for now...)
             typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
@@ -492,7 +541,7 @@ namespace MayanSort {
 
             // use a small cache to speed up some of the operations
 #if DYNAMIC_CACHE
-            Cache<T> cache_obj(size);
+            Cache<T, Allocator> cache_obj(size, alloc);
             T* cache = cache_obj.cache;
             const std::size_t cache_size = cache_obj.cache_size;
 #else
@@ -506,6 +555,10 @@ namespace MayanSort {
 
             // then merge sort the higher levels, which can be 8-15, 16-31, 32-63, 64-127, etc.
             while (true) {
+#if DYNAMIC_CACHE
+                // no level writes more than 4 * (iterator.length() + 1) items into the cache
+                cache_obj.Prime(first, std::min(cache_size, 4 * (iterator.length() + 1)));
+#endif
                 // if every A and B block will fit into the cache, use a special branch specifically for merging with the cache
                 // (we use < rather than <= since the block size might be one more than iterator.length())
                 if (iterator.length() < cache_size) {
@@ -528,7 +581,7 @@ namespace MayanSort {
                             }
                             else if (compare(*B1.start, *(A1.end - 1))) {
                                 // these two ranges weren't already in order, so merge them into the cache
-                                std::merge(A1.start, A1.end, B1.start, B1.end, cache, compare);
+                                MergeInto(A1.start, A1.end, B1.start, B1.end, cache, compare);
                             }
                             else {
                                 // if A1, B1, A2, and B2 are all in order, skip doing anything else
@@ -548,7 +601,7 @@ namespace MayanSort {
                             }
                             else if (compare(*B2.start, *(A2.end - 1))) {
                                 // these two ranges weren't already in order, so merge them into the cache
-                                std::merge(A2.start, A2.end, B2.start, B2.end, cache + A1.length(), compare);
+                                MergeInto(A2.start, A2.end, B2.start, B2.end, cache + A1.length(), compare);
                             }
                             else {
                                 // copy A2 and B2 into the cache in the same order at once
@@ -567,7 +620,7 @@ namespace MayanSort {
                             }
                             else if (compare(*B3.start, *(A3.end - 1))) {
                                 // these two ranges weren't already in order, so merge them back into the array
-                                std::merge(A3.start, A3.end, B3.start, B3.end, A1.start, compare);
+                                MergeInto(A3.start, A3.end, B3.start, B3.end, A1.start, compare);
                             }
                             else {
                                 // copy A3 and B3 into the array in the same order at once